@@ -297,6 +297,7 @@ static struct name_to_val_mapping stats_filters_names[] = {
 	{ .short_name = "req", .value = STATS_FILTER_REQ },
 	{ .short_name = "blk", .value = STATS_FILTER_BLK },
 	{ .short_name = "err", .value = STATS_FILTER_ERR },
+	{ .short_name = "netcas", .value = STATS_FILTER_NETCAS },
 	{ .short_name = "all", .value = STATS_FILTER_ALL },
 	{ NULL }
 };
@@ -1397,6 +1398,164 @@ int cache_params_get(unsigned int cache_id, struct cas_param *params,
 	return SUCCESS;
 }
 
+static const char *netcas_mode_names[] = {
+	"idle",
+	"warmup",
+	"stable",
+	"congestion",
+	"failure",
+};
+
+static const char *netcas_policy_names[] = {
+	"formula",
+	"hill-climb",
+};
+
+static void print_netcas_ratio(FILE *outfile, const char *name,
+		uint64_t ratio)
+{
+	fprintf(outfile, TAG(TABLE_ROW) "%s,%llu.%02llu %%\n", name,
+			(unsigned long long)ratio / 100,
+			(unsigned long long)ratio % 100);
+}
+
+static void print_netcas_value(FILE *outfile, const char *name,
+		long long value, const char *unit)
+{
+	fprintf(outfile, TAG(TABLE_ROW) "%s,%lld %s\n", name, value, unit);
+}
+
+/* Statistics fed by engine hooks the engine doesn't call are always zero */
+static void print_netcas_hook_value(FILE *outfile, const char *name,
+		bool active, long long value, const char *unit)
+{
+	if (active)
+		print_netcas_value(outfile, name, value, unit);
+	else
+		fprintf(outfile, TAG(TABLE_ROW) "%s,inactive\n", name);
+}
+
+static const char *netcas_name(const char **names, unsigned int count,
+		uint32_t id)
+{
+	return id < count ? names[id] : "unknown";
+}
+
+int netcas_control(struct kcas_netcas *cmd, unsigned int output_format)
+{
+	FILE *intermediate_file[2];
+	FILE *out;
+	bool completions, hedging;
+	int fd = 0;
+
+	fd = open_ctrl_device();
+	if (fd == -1)
+		return FAILURE;
+
+	if (run_ioctl(fd, KCAS_IOCTL_NETCAS, cmd) < 0) {
+		close(fd);
+		if (cmd->ext_err_code == OCF_ERR_CACHE_NOT_EXIST)
+			cas_printf(LOG_ERR, "Cache id %d not running\n",
+					cmd->cache_id);
+		else if (cmd->ext_err_code == OCF_ERR_INVAL)
+			cas_printf(LOG_ERR, "Invalid netCAS parameters\n");
+		else
+			print_err(cmd->ext_err_code);
+		return FAILURE;
+	}
+	close(fd);
+
+	if (create_pipe_pair(intermediate_file)) {
+		cas_printf(LOG_ERR,"Failed to create unidirectional pipe.\n");
+		return FAILURE;
+	}
+	out = intermediate_file[1];
+	completions = cmd->engine_hooks & KCAS_NETCAS_HOOK_COMPLETION;
+	hedging = cmd->engine_hooks & KCAS_NETCAS_HOOK_HEDGE;
+
+	fprintf(out, TAG(TABLE_HEADER) "Parameter name,Value\n");
+	print_netcas_value(out, "Monitor interval",
+			cmd->monitor_interval_ms, "[ms]");
+	print_netcas_value(out, "Log interval", cmd->log_interval_ms, "[ms]");
+	print_netcas_value(out, "Congestion threshold",
+			cmd->latency_congestion_threshold, "[permil]");
+	print_netcas_value(out, "Recovery threshold",
+			cmd->latency_recovery_threshold, "[permil]");
+	if (cmd->pinned_ratio == KCAS_NETCAS_RATIO_UNPINNED)
+		fprintf(out, TAG(TABLE_ROW) "Pinned split ratio,none\n");
+	else
+		print_netcas_ratio(out, "Pinned split ratio",
+				cmd->pinned_ratio);
+	fprintf(out, TAG(TABLE_ROW) "Policy,%s\n",
+			netcas_name(netcas_policy_names,
+				ARRAY_SIZE(netcas_policy_names), cmd->policy));
+	print_netcas_value(out, "p99 target", cmd->p99_target_ns / 1000,
+			"[us]");
+	print_netcas_value(out, "Hedge budget", cmd->hedge_budget,
+			"[permil]");
+	print_netcas_value(out, "Hedge percentile", cmd->hedge_percentile,
+			"[permil]");
+
+	fprintf(out, TAG(TABLE_ROW) "Mode,%s\n",
+			netcas_name(netcas_mode_names,
+				ARRAY_SIZE(netcas_mode_names), cmd->mode));
+	fprintf(out, TAG(TABLE_ROW) "Active policy,%s\n",
+			netcas_name(netcas_policy_names,
+				ARRAY_SIZE(netcas_policy_names),
+				cmd->active_policy));
+	print_netcas_ratio(out, "Optimal split ratio", cmd->optimal_ratio);
+	print_netcas_ratio(out, "Small IO split ratio",
+			cmd->published_ratio[kcas_netcas_size_small]);
+	print_netcas_ratio(out, "Medium IO split ratio",
+			cmd->published_ratio[kcas_netcas_size_medium]);
+	print_netcas_ratio(out, "Large IO split ratio",
+			cmd->published_ratio[kcas_netcas_size_large]);
+	print_netcas_ratio(out, "Achieved split ratio", cmd->achieved_ratio);
+	print_netcas_ratio(out, "Dirty hit ratio", cmd->dirty_hit_ratio);
+	print_netcas_value(out, "RDMA throughput", cmd->rdma_throughput, "");
+	print_netcas_value(out, "Max RDMA throughput",
+			cmd->max_rdma_throughput, "");
+	print_netcas_value(out, "RDMA latency", cmd->rdma_latency, "");
+	print_netcas_value(out, "Min RDMA latency", cmd->min_rdma_latency, "");
+	print_netcas_value(out, "Bandwidth drop", cmd->bw_drop_permil,
+			"[permil]");
+	print_netcas_value(out, "Latency increase",
+			cmd->latency_increase_permil, "[permil]");
+	print_netcas_hook_value(out, "Cache throughput", completions,
+			cmd->cache_throughput, "[B/s]");
+	print_netcas_hook_value(out, "Backend throughput", completions,
+			cmd->backend_throughput, "[B/s]");
+	print_netcas_hook_value(out, "Cache p99 latency", completions,
+			cmd->cache_p99_ns / 1000, "[us]");
+	print_netcas_hook_value(out, "Backend p99 latency", completions,
+			cmd->backend_p99_ns / 1000, "[us]");
+	print_netcas_hook_value(out, "IO depth", completions, cmd->io_depth,
+			"");
+	print_netcas_hook_value(out, "Jobs", completions, cmd->numjob, "");
+	print_netcas_hook_value(out, "Tail bias", completions, cmd->tail_bias,
+			"[0.01 %]");
+	print_netcas_hook_value(out, "Cache hedge delay", hedging,
+			cmd->cache_hedge_delay_ns / 1000, "[us]");
+	print_netcas_hook_value(out, "Backend hedge delay", hedging,
+			cmd->backend_hedge_delay_ns / 1000, "[us]");
+	print_netcas_hook_value(out, "Hedged reads", hedging, cmd->hedges, "");
+	print_netcas_hook_value(out, "Hedged reads won", hedging,
+			cmd->hedge_wins, "");
+	print_netcas_value(out, "Backend budget", cmd->backend_budget,
+			"[B/s]");
+	print_netcas_value(out, "Throttled backend IO", cmd->throttled_ios, "");
+	fprintf(out, TAG(TABLE_ROW) "Read target selection,%s\n",
+			cmd->engine_hooks & KCAS_NETCAS_HOOK_TARGET ?
+				"active" : "inactive");
+	fflush(out);
+
+	fclose(intermediate_file[1]);
+	stat_format_output(intermediate_file[0], stdout, output_format);
+	fclose(intermediate_file[0]);
+
+	return SUCCESS;
+}
+
 int check_core_already_cached(const char *core_device) {
 	struct cache_device **caches, *curr_cache;
 	struct core_device *curr_core;
@@ -2006,6 +2165,8 @@ int flush_core(unsigned int cache_id, unsigned int core_id)
 struct partition_config_col {
 	const char *name;
 	int pos;
+	/* Column may be omitted from configuration file */
+	bool optional;
 };
 
 static struct partition_config_col partition_config_columns[] = {
@@ -2013,6 +2174,8 @@ static struct partition_config_col partition_config_columns[] = {
 	{ .name = "IO class name", .pos = -1 },
 	{ .name = "Eviction priority", .pos = -1 },
 	{ .name = "Allocation", .pos = -1 },
+	{ .name = "netCAS min split", .pos = -1, .optional = true },
+	{ .name = "netCAS max split", .pos = -1, .optional = true },
 	{ .name = NULL }
 };
 
@@ -2032,8 +2195,11 @@ void partition_list_line(FILE *out, struct kcas_io_class *cls, bool csv)
 		prio = buffer;
 	}
 
-	fprintf(out, TAG(TABLE_ROW)"%u,%s,%s,%s\n",
-		cls->class_id, cls->info.name, prio, allocation_str);
+	/* netCAS bounds in the 0-1 format of the configuration file */
+	fprintf(out, TAG(TABLE_ROW)"%u,%s,%s,%s,%u.%04u,%u.%04u\n",
+		cls->class_id, cls->info.name, prio, allocation_str,
+		cls->netcas.min_split / 10000, cls->netcas.min_split % 10000,
+		cls->netcas.max_split / 10000, cls->netcas.max_split % 10000);
 
 }
 
@@ -2111,6 +2277,8 @@ enum {
 	part_csv_coll_name,
 	part_csv_coll_prio,
 	part_csv_coll_alloc,
+	part_csv_coll_netcas_min,
+	part_csv_coll_netcas_max,
 	part_csv_coll_max
 };
 
@@ -2142,6 +2310,11 @@ static inline const char *partition_get_csv_col(CSVFILE *csv, int col,
 {
 	const char *val;
 
+	if (partition_config_columns[col].pos < 0) {
+		/* optional column missing from file - use default */
+		return "";
+	}
+
 	val = csv_get_col(csv, partition_config_columns[col].pos);
 	if (!val) {
 		*error_col = col;
@@ -2170,6 +2343,26 @@ static int calculate_max_allocation(uint16_t cache_id, const char *allocation,
 	return SUCCESS;
 }
 
+static int calculate_netcas_split(const char *split, uint16_t *split_ratio)
+{
+	float ratio = 0;
+	char *end;
+
+	if (strnlen(split, MAX_STR_LEN) > 6)
+		return FAILURE;
+
+	ratio = strtof(split, &end);
+	if (ratio > 1 || ratio < 0)
+		return FAILURE;
+
+	if (split + strnlen(split, MAX_STR_LEN) != end)
+		return FAILURE;
+
+	*split_ratio = (uint16_t)round(ratio * 10000);
+
+	return SUCCESS;
+}
+
 
 static inline int partition_get_line(CSVFILE *csv,
 				     struct kcas_io_classes *cnfg,
@@ -2177,7 +2370,7 @@ static inline int partition_get_line(CSVFILE *csv,
 {
 	uint32_t part_id;
 	uint32_t value;
-	const char *id, *name, *prio, *alloc;
+	const char *id, *name, *prio, *alloc, *netcas_min, *netcas_max;
 
 	id = partition_get_csv_col(csv, part_csv_coll_id, error_col);
 	if (!id) {
@@ -2195,6 +2388,16 @@ static inline int partition_get_line(CSVFILE *csv,
 	if (!alloc) {
 		return FAILURE;
 	}
+	netcas_min = partition_get_csv_col(csv, part_csv_coll_netcas_min,
+			error_col);
+	if (!netcas_min) {
+		return FAILURE;
+	}
+	netcas_max = partition_get_csv_col(csv, part_csv_coll_netcas_max,
+			error_col);
+	if (!netcas_max) {
+		return FAILURE;
+	}
 
 	/* Validate ID */
 	*error_col = part_csv_coll_id;
@@ -2249,10 +2452,27 @@ static inline int partition_get_line(CSVFILE *csv,
 	cnfg->info[part_id].min_size = 0;
 	cnfg->info[part_id].max_size = value;
 
+	/* Validate netCAS split bounds, empty means unbounded */
+	*error_col = part_csv_coll_netcas_min;
+	if (!strempty(netcas_min) && calculate_netcas_split(netcas_min,
+			&cnfg->netcas[part_id].min_split) == FAILURE) {
+		return FAILURE;
+	}
+
+	*error_col = part_csv_coll_netcas_max;
+	if (!strempty(netcas_max) && calculate_netcas_split(netcas_max,
+			&cnfg->netcas[part_id].max_split) == FAILURE) {
+		return FAILURE;
+	}
+	if (cnfg->netcas[part_id].min_split > cnfg->netcas[part_id].max_split) {
+		cas_printf(LOG_ERR, "netCAS min split greater than max split\n");
+		return FAILURE;
+	}
+
 	return 0;
 }
 
-static int partition_parse_header(CSVFILE *csv)
+static int partition_parse_header(CSVFILE *csv, int *header_cols)
 {
 	int i, j, csv_cols;
 	const char *col_name;
@@ -2281,13 +2501,16 @@ static int partition_parse_header(CSVFILE *csv)
 	}
 
 	for (i = 0; partition_config_columns[i].name; i++) {
-		if (partition_config_columns[i].pos < 0) {
+		if (partition_config_columns[i].pos < 0 &&
+				!partition_config_columns[i].optional) {
 			cas_printf(LOG_ERR,
 				   "Cannot parse configuration file - missing column \"%s\".\n",
 				   partition_config_columns[i].name);
 			return FAILURE;
 		}
 	}
+
+	*header_cols = csv_cols;
 	return SUCCESS;
 }
 
@@ -2297,9 +2520,17 @@ int partition_get_config(CSVFILE *csv, struct kcas_io_classes *cnfg,
 	int result = 0, count = 0;
 	int line = 1;
 	int error_col = -1;
+	int header_cols = 0;
+	int i;
 
 	cnfg->cache_id = cache_id;
 
+	/* IO classes not bounded in configuration file may be split freely */
+	for (i = 0; i < OCF_USER_IO_CLASS_MAX; i++) {
+		cnfg->netcas[i].min_split = 0;
+		cnfg->netcas[i].max_split = 10000;
+	}
+
 	/* before reading io class configuration check header */
 	if (csv_read(csv)) {
 		if (csv_feof(csv)) {
@@ -2316,7 +2547,7 @@ int partition_get_config(CSVFILE *csv, struct kcas_io_classes *cnfg,
 		}
 	}
 
-	if (partition_parse_header(csv)) {
+	if (partition_parse_header(csv, &header_cols)) {
 		cas_printf(LOG_ERR, "Failed to parse I/O classes"
 			   " configuration file header. It is either"
 			   " malformed or missing.\n"
@@ -2338,7 +2569,7 @@ int partition_get_config(CSVFILE *csv, struct kcas_io_classes *cnfg,
 			}
 		}
 
-		if (part_csv_coll_max != csv_count_cols(csv)) {
+		if (header_cols != csv_count_cols(csv)) {
 			if (csv_empty_line(csv)) {
 				continue;
 			} else {
@@ -76,14 +76,17 @@ enum output_format_t {
 #define STATS_FILTER_BLK (1 << 3)
 #define STATS_FILTER_ERR (1 << 4)
 #define STATS_FILTER_IOCLASS (1 << 5)
+#define STATS_FILTER_NETCAS (1 << 6)
 #define STATS_FILTER_ALL (STATS_FILTER_CONF |	\
 			  STATS_FILTER_USAGE |	\
 			  STATS_FILTER_REQ |	\
 			  STATS_FILTER_BLK |	\
-			  STATS_FILTER_ERR)
+			  STATS_FILTER_ERR |	\
+			  STATS_FILTER_NETCAS)
 #define STATS_FILTER_DEFAULT STATS_FILTER_ALL
 
-#define STATS_FILTER_COUNTERS (STATS_FILTER_REQ | STATS_FILTER_BLK | STATS_FILTER_ERR)
+#define STATS_FILTER_COUNTERS (STATS_FILTER_REQ | STATS_FILTER_BLK | \
+			       STATS_FILTER_ERR | STATS_FILTER_NETCAS)
 
 const char *cleaning_policy_to_name(uint8_t policy);
 const char *promotion_policy_to_name(uint8_t policy);
@@ -157,6 +160,15 @@ int cache_get_param(unsigned int cache_id, unsigned int param_id,
 int cache_params_get(unsigned int cache_id, struct cas_param *params,
 		unsigned int output_format);
 
+/**
+ * @brief handle netCAS splitter command
+ * @param cmd settings to apply, as marked in set_flags
+ * @param output_format table or csv
+ * @return exit code of successful completion is 0;
+ * nonzero exit code means failure
+ */
+int netcas_control(struct kcas_netcas *cmd, unsigned int output_format);
+
 /**
  * @brief handle set core param command
  * @param cache_id id of cache device
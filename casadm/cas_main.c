@@ -456,7 +456,7 @@ static cli_option stats_options[] = {
 	{'i', "cache-id", CACHE_ID_DESC, 1, "ID", CLI_OPTION_REQUIRED},
 	{'j', "core-id", "Limit display of core-specific statistics to only ones pertaining to a specific core. If this option is not given, casadm will display statistics pertaining to all cores assigned to given cache instance.", 1, "ID", 0},
 	{'d', "io-class-id", "Display per IO class statistics", 1, "ID", CLI_OPTION_OPTIONAL_ARG},
-	{'f', "filter", "Apply filters from the following set: {all, conf, usage, req, blk, err}", 1, "FILTER-SPEC"},
+	{'f', "filter", "Apply filters from the following set: {all, conf, usage, req, blk, err, netcas}", 1, "FILTER-SPEC"},
 	{'o', "output-format", "Output format: {table|csv}", 1, "FORMAT"},
 	{'b', "by-id-path", "Display by-id path to disks instead of short form /dev/sdx"},
 	{0}
@@ -645,6 +645,11 @@ uint32_t seq_cutoff_threshold_transform(uint32_t value)
 	return value / KiB;
 }
 
+uint32_t io_split_max_size_transform(uint32_t value)
+{
+	return value / KiB;
+}
+
 static char *seq_cutoff_policy_values[] = {
 	[ocf_seq_cutoff_policy_always] = "always",
 	[ocf_seq_cutoff_policy_full] = "full",
@@ -665,6 +670,11 @@ static struct cas_param cas_core_params[] = {
 	[core_param_seq_cutoff_promotion_count] = {
 		.name = "Sequential cutoff promotion request count threshold",
 	},
+	/* I/O split params */
+	[core_param_io_split_max_size] = {
+		.name = "I/O split max size [KiB]",
+		.transform_value = io_split_max_size_transform,
+	},
 	{0},
 };
 
@@ -681,6 +691,13 @@ static char *promotion_policy_type_values[] = {
 	NULL,
 };
 
+static char *io_queue_policy_values[] = {
+	[io_queue_policy_per_cpu] = "per-cpu",
+	[io_queue_policy_numa_node] = "numa-node",
+	[io_queue_policy_device_local] = "device-local",
+	NULL,
+};
+
 static struct cas_param cas_cache_params[] = {
 	/* Cleaning policy type */
 	[cache_param_cleaning_policy_type] = {
@@ -723,6 +740,12 @@ static struct cas_param cas_cache_params[] = {
 	[cache_param_promotion_nhit_trigger_threshold] = {
 		.name = "Policy trigger [%]",
 	},
+
+	/* IO queue policy */
+	[cache_param_io_queue_policy] = {
+		.name = "IO queue policy",
+		.value_names = io_queue_policy_values,
+	},
 	{0},
 };
 
@@ -735,6 +758,9 @@ static struct cas_param cas_cache_params[] = {
 	"Available policies: {always|full|never}"
 #define SEQ_CUT_OFF_PROMO_COUNT_DESC "Sequential cutoff stream promotion request count threshold"
 
+#define IO_SPLIT_MAX_SIZE_DESC "Max size of I/O a request to exported object is split into " \
+	"<4-32768>[KiB], multiple of 4 KiB (0 - derived from cache and core devices)"
+
 #define CLEANING_POLICY_TYPE_DESC "Cleaning policy type. " \
 	"Available policy types: {nop|alru|acp}"
 
@@ -759,6 +785,9 @@ static struct cas_param cas_cache_params[] = {
 #define PROMOTION_NHIT_THRESHOLD_DESC "Number of requests for given core line " \
 	"after which NHIT policy allows insertion into cache <%d-%d> (default: %d)"
 
+#define IO_QUEUE_POLICY_DESC "Policy of mapping submitting CPU to IO queue. " \
+	"Available policies: {per-cpu|numa-node|device-local}"
+
 static cli_namespace set_param_namespace = {
 	.short_name = 'n',
 	.long_name = "name",
@@ -769,6 +798,10 @@ static cli_namespace set_param_namespace = {
 			{0, "promotion-count", SEQ_CUT_OFF_PROMO_COUNT_DESC, 1, "NUMBER", 0},
 		CORE_PARAMS_NS_END()
 
+		CORE_PARAMS_NS_BEGIN("io-split", "I/O split parameters")
+			{'s', "max-size", IO_SPLIT_MAX_SIZE_DESC, 1, "KiB", 0},
+		CORE_PARAMS_NS_END()
+
 		CACHE_PARAMS_NS_BEGIN("cleaning", "Cleaning policy parameters")
 			{'p', "policy", CLEANING_POLICY_TYPE_DESC, 1, "POLICY", 0},
 		CACHE_PARAMS_NS_END()
@@ -818,6 +851,10 @@ static cli_namespace set_param_namespace = {
 				OCF_ACP_DEFAULT_FLUSH_MAX_BUFFERS},
 		CACHE_PARAMS_NS_END()
 
+		CACHE_PARAMS_NS_BEGIN("io-queue", "IO queue parameters")
+			{'p', "policy", IO_QUEUE_POLICY_DESC, 1, "POLICY", 0},
+		CACHE_PARAMS_NS_END()
+
 		{0},
 	},
 };
@@ -859,6 +896,33 @@ int set_param_seq_cutoff_handle_option(char *opt, const char **arg)
 	return SUCCESS;
 }
 
+int set_param_io_split_handle_option(char *opt, const char **arg)
+{
+	if (!strcmp(opt, "max-size")) {
+		if (validate_str_num(arg[0], "I/O split max size",
+					0, (32 * MiB) / KiB) == FAILURE)
+			return FAILURE;
+
+		if (atoi(arg[0]) % 4) {
+			cas_printf(LOG_ERR, "Error: I/O split max size has to be "
+					"a multiple of 4 KiB.\n");
+			return FAILURE;
+		}
+
+		if (atoi(arg[0]) && atoi(arg[0]) < 4) {
+			cas_printf(LOG_ERR, "Error: I/O split max size has to be "
+					"at least 4 KiB.\n");
+			return FAILURE;
+		}
+
+		SET_CORE_PARAM(core_param_io_split_max_size, atoi(arg[0]) * KiB);
+	} else {
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
 int set_param_cleaning_handle_option(char *opt, const char **arg)
 {
 	if (!strcmp(opt, "policy")) {
@@ -966,6 +1030,29 @@ int set_param_promotion_handle_option(char *opt, const char **arg)
 	return SUCCESS;
 }
 
+int set_param_io_queue_handle_option(char *opt, const char **arg)
+{
+	if (!strcmp(opt, "policy")) {
+		if (!strcmp("per-cpu", arg[0])) {
+			SET_CACHE_PARAM(cache_param_io_queue_policy,
+					io_queue_policy_per_cpu);
+		} else if (!strcmp("numa-node", arg[0])) {
+			SET_CACHE_PARAM(cache_param_io_queue_policy,
+					io_queue_policy_numa_node);
+		} else if (!strcmp("device-local", arg[0])) {
+			SET_CACHE_PARAM(cache_param_io_queue_policy,
+					io_queue_policy_device_local);
+		} else {
+			cas_printf(LOG_ERR, "Error: Invalid policy name.\n");
+			return FAILURE;
+		}
+	} else {
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
 int set_param_promotion_nhit_handle_option(char *opt, const char **arg)
 {
 	if (!strcmp(opt, "threshold")) {
@@ -996,6 +1083,9 @@ int set_param_namespace_handle_option(char *namespace, char *opt, const char **a
 	if (!strcmp(namespace, "seq-cutoff")) {
 		return core_param_handle_option_generic(opt, arg,
 				set_param_seq_cutoff_handle_option);
+	} else if (!strcmp(namespace, "io-split")) {
+		return core_param_handle_option_generic(opt, arg,
+				set_param_io_split_handle_option);
 	} else if (!strcmp(namespace, "cleaning")) {
 		return cache_param_handle_option_generic(opt, arg,
 				set_param_cleaning_handle_option);
@@ -1008,6 +1098,9 @@ int set_param_namespace_handle_option(char *namespace, char *opt, const char **a
 	} else if (!strcmp(namespace, "promotion")) {
 		return cache_param_handle_option_generic(opt, arg,
 				set_param_promotion_handle_option);
+	} else if (!strcmp(namespace, "io-queue")) {
+		return cache_param_handle_option_generic(opt, arg,
+				set_param_io_queue_handle_option);
 	} else if (!strcmp(namespace, "promotion-nhit")) {
 		return cache_param_handle_option_generic(opt, arg,
 				set_param_promotion_nhit_handle_option);
@@ -1056,11 +1149,13 @@ static cli_namespace get_param_namespace = {
 	.long_name = "name",
 	.entries = {
 		GET_CORE_PARAMS_NS("seq-cutoff", "Sequential cutoff parameters")
+		GET_CORE_PARAMS_NS("io-split", "I/O split parameters")
 		GET_CACHE_PARAMS_NS("cleaning", "Cleaning policy parameters")
 		GET_CACHE_PARAMS_NS("cleaning-alru", "Cleaning policy ALRU parameters")
 		GET_CACHE_PARAMS_NS("cleaning-acp", "Cleaning policy ACP parameters")
 		GET_CACHE_PARAMS_NS("promotion", "Promotion policy parameters")
 		GET_CACHE_PARAMS_NS("promotion-nhit", "Promotion policy NHIT parameters")
+		GET_CACHE_PARAMS_NS("io-queue", "IO queue parameters")
 
 		{0},
 	},
@@ -1087,6 +1182,10 @@ int get_param_namespace_handle_option(char *namespace, char *opt, const char **a
 		SELECT_CORE_PARAM(core_param_seq_cutoff_promotion_count);
 		return core_param_handle_option_generic(opt, arg,
 				get_param_handle_option);
+	} else if (!strcmp(namespace, "io-split")) {
+		SELECT_CORE_PARAM(core_param_io_split_max_size);
+		return core_param_handle_option_generic(opt, arg,
+				get_param_handle_option);
 	} else if (!strcmp(namespace, "cleaning")) {
 		SELECT_CACHE_PARAM(cache_param_cleaning_policy_type);
 		return cache_param_handle_option_generic(opt, arg,
@@ -1107,6 +1206,10 @@ int get_param_namespace_handle_option(char *namespace, char *opt, const char **a
 		SELECT_CACHE_PARAM(cache_param_promotion_policy_type);
 		return cache_param_handle_option_generic(opt, arg,
 				get_param_handle_option);
+	} else if (!strcmp(namespace, "io-queue")) {
+		SELECT_CACHE_PARAM(cache_param_io_queue_policy);
+		return cache_param_handle_option_generic(opt, arg,
+				get_param_handle_option);
 	} else if (!strcmp(namespace, "promotion-nhit")) {
 		SELECT_CACHE_PARAM(cache_param_promotion_nhit_insertion_threshold);
 		SELECT_CACHE_PARAM(cache_param_promotion_nhit_trigger_threshold);
@@ -2148,6 +2251,168 @@ void standby_help(app *app_values, cli_command *cmd)
 	cmd_subcmd_help(app_values, cmd, standby_opt_flag_required);
 }
 
+/*******************************************************************************
+ * netCAS splitter command
+ ******************************************************************************/
+
+static struct {
+	struct kcas_netcas cmd;
+	bool congestion_threshold;
+	bool recovery_threshold;
+} netcas_params = {
+	.cmd = {
+		.cache_id = OCF_CACHE_ID_INVALID,
+	},
+};
+
+static const char *netcas_policy_names[] = {
+	"formula",
+	"hill-climb",
+	NULL,
+};
+
+static cli_option netcas_options[] = {
+	{'i', "cache-id", CACHE_ID_DESC, 1, "ID", CLI_OPTION_REQUIRED},
+	{0, "interval", "Splitter monitor interval in milliseconds <1-10000>", 1, "MS", 0},
+	{0, "log-interval", "Splitter log interval in milliseconds, 0 disables logging <0-3600000>", 1, "MS", 0},
+	{0, "congestion-threshold", "Latency increase entering congestion mode in permil <0-1000>", 1, "NUMBER", 0},
+	{0, "recovery-threshold", "Latency increase leaving congestion mode in permil, not above congestion threshold <0-1000>", 1, "NUMBER", 0},
+	{0, "pin", "Pin split ratio, share of hits served by cache <0-10000>", 1, "RATIO", 0},
+	{0, "unpin", "Return split ratio control to the splitter"},
+	{0, "policy", "Split ratio controller: {formula|hill-climb}", 1, "NAME", 0},
+	{0, "p99-target", "p99 completion latency objective in microseconds, 0 disables it", 1, "US", 0},
+	{0, "hedge-budget", "Hedged reads per 1000 clean hits, 0 disables hedging <0-500>", 1, "NUMBER", 0},
+	{0, "hedge-percentile", "Path latency percentile in permil after which a read is hedged <500-999>", 1, "NUMBER", 0},
+	{0, "reset", "Reset splitter state and statistics"},
+	{'o', "output-format", "Output format: {table|csv}", 1, "FORMAT"},
+	{0}
+};
+
+int netcas_handle_option(char *opt, const char **arg)
+{
+	struct kcas_netcas *cmd = &netcas_params.cmd;
+	int i;
+
+	if (!strcmp(opt, "cache-id")) {
+		if (validate_str_num(arg[0], "cache id", OCF_CACHE_ID_MIN,
+				OCF_CACHE_ID_MAX) == FAILURE)
+			return FAILURE;
+
+		cmd->cache_id = atoi(arg[0]);
+	} else if (!strcmp(opt, "interval")) {
+		if (validate_str_num(arg[0], "monitor interval", 1,
+				10000) == FAILURE)
+			return FAILURE;
+
+		cmd->monitor_interval_ms = strtoul(arg[0], NULL, 10);
+		cmd->set_flags |= KCAS_NETCAS_SET_INTERVAL;
+	} else if (!strcmp(opt, "log-interval")) {
+		if (validate_str_num(arg[0], "log interval", 0,
+				3600000) == FAILURE)
+			return FAILURE;
+
+		cmd->log_interval_ms = strtoul(arg[0], NULL, 10);
+		cmd->set_flags |= KCAS_NETCAS_SET_LOG_INTERVAL;
+	} else if (!strcmp(opt, "congestion-threshold")) {
+		if (validate_str_num(arg[0], "congestion threshold", 0,
+				1000) == FAILURE)
+			return FAILURE;
+
+		cmd->latency_congestion_threshold = strtoul(arg[0], NULL, 10);
+		netcas_params.congestion_threshold = true;
+	} else if (!strcmp(opt, "recovery-threshold")) {
+		if (validate_str_num(arg[0], "recovery threshold", 0,
+				1000) == FAILURE)
+			return FAILURE;
+
+		cmd->latency_recovery_threshold = strtoul(arg[0], NULL, 10);
+		netcas_params.recovery_threshold = true;
+	} else if (!strcmp(opt, "pin")) {
+		if (validate_str_num(arg[0], "split ratio", 0,
+				10000) == FAILURE)
+			return FAILURE;
+
+		cmd->pinned_ratio = strtoul(arg[0], NULL, 10);
+		cmd->set_flags |= KCAS_NETCAS_SET_PIN;
+	} else if (!strcmp(opt, "unpin")) {
+		cmd->set_flags |= KCAS_NETCAS_SET_UNPIN;
+	} else if (!strcmp(opt, "policy")) {
+		for (i = 0; netcas_policy_names[i]; i++) {
+			if (!strcmp(arg[0], netcas_policy_names[i]))
+				break;
+		}
+		if (!netcas_policy_names[i]) {
+			cas_printf(LOG_ERR, "Invalid policy name\n");
+			return FAILURE;
+		}
+
+		cmd->policy = i;
+		cmd->set_flags |= KCAS_NETCAS_SET_POLICY;
+	} else if (!strcmp(opt, "p99-target")) {
+		if (validate_str_num(arg[0], "p99 target", 0,
+				UINT32_MAX) == FAILURE)
+			return FAILURE;
+
+		cmd->p99_target_ns = strtoull(arg[0], NULL, 10) * 1000;
+		cmd->set_flags |= KCAS_NETCAS_SET_P99_TARGET;
+	} else if (!strcmp(opt, "hedge-budget")) {
+		if (validate_str_num(arg[0], "hedge budget", 0,
+				500) == FAILURE)
+			return FAILURE;
+
+		cmd->hedge_budget = strtoul(arg[0], NULL, 10);
+		cmd->set_flags |= KCAS_NETCAS_SET_HEDGE_BUDGET;
+	} else if (!strcmp(opt, "hedge-percentile")) {
+		if (validate_str_num(arg[0], "hedge percentile", 500,
+				999) == FAILURE)
+			return FAILURE;
+
+		cmd->hedge_percentile = strtoul(arg[0], NULL, 10);
+		cmd->set_flags |= KCAS_NETCAS_SET_HEDGE_PERCENTILE;
+	} else if (!strcmp(opt, "reset")) {
+		cmd->set_flags |= KCAS_NETCAS_SET_RESET;
+	} else if (!strcmp(opt, "output-format")) {
+		command_args_values.output_format =
+			validate_str_output_format(arg[0]);
+		if (OUTPUT_FORMAT_INVALID == command_args_values.output_format)
+			return FAILURE;
+	} else {
+		return FAILURE;
+	}
+
+	return 0;
+}
+
+int handle_netcas()
+{
+	struct kcas_netcas *cmd = &netcas_params.cmd;
+
+	if (netcas_params.congestion_threshold !=
+			netcas_params.recovery_threshold) {
+		cas_printf(LOG_ERR, "Congestion and recovery thresholds "
+				"must be given together\n");
+		return FAILURE;
+	}
+	if (netcas_params.congestion_threshold) {
+		if (cmd->latency_recovery_threshold >
+				cmd->latency_congestion_threshold) {
+			cas_printf(LOG_ERR, "Recovery threshold must not "
+					"exceed congestion threshold\n");
+			return FAILURE;
+		}
+		cmd->set_flags |= KCAS_NETCAS_SET_THRESHOLDS;
+	}
+
+	if ((cmd->set_flags & KCAS_NETCAS_SET_PIN) &&
+			(cmd->set_flags & KCAS_NETCAS_SET_UNPIN)) {
+		cas_printf(LOG_ERR, "Options --pin and --unpin are mutually "
+				"exclusive\n");
+		return FAILURE;
+	}
+
+	return netcas_control(cmd, command_args_values.output_format);
+}
+
 /*******************************************************************************
  * Zero metadata command
  ******************************************************************************/
@@ -2401,6 +2666,16 @@ static cli_command cas_commands[] = {
 			.flags = CLI_SU_REQUIRED,
 			.help = standby_help,
 		},
+		{
+			.name = "netcas",
+			.desc = "Tune netCAS splitter and display its state",
+			.long_desc = NULL,
+			.options = netcas_options,
+			.command_handle_opts = netcas_handle_option,
+			.handle = handle_netcas,
+			.flags = CLI_SU_REQUIRED,
+			.help = NULL
+		},
 		{
 			.name = "zero-metadata",
 			.desc = "Clear metadata from caching device",
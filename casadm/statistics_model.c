@@ -386,6 +386,82 @@ static void print_err_stats(const struct ocf_stats_errors *stats,
 					 stats->total.value);
 }
 
+static const char *netcas_mode_time_names[KCAS_NETCAS_MODES] = {
+	"Time in idle mode",
+	"Time in warmup mode",
+	"Time in stable mode",
+	"Time in congestion mode",
+	"Time in failure mode",
+};
+
+static void print_netcas_stats(const struct kcas_netcas_stats *stats,
+		FILE *outfile)
+{
+	uint64_t hits = stats->cache_hits + stats->backend_hits +
+			stats->dirty_hits;
+	uint64_t hit_bytes = stats->cache_hit_bytes + stats->backend_hit_bytes;
+	uint64_t bytes = stats->cache_bytes + stats->backend_bytes;
+	uint64_t time_us = 0;
+	int mode;
+
+	/* Cache runs without netCAS splitter */
+	if (!stats->enabled)
+		return;
+
+	print_table_header(outfile, 4, "netCAS statistics", "Count", "%",
+			   "[Units]");
+
+	print_val_perc_table_section(outfile, "Clean hits served by cache",
+				     UNIT_REQUESTS, fraction(stats->cache_hits, hits),
+				     "%lu", stats->cache_hits);
+	print_val_perc_table_row(outfile, "Clean hits offloaded to backend",
+				 UNIT_REQUESTS, fraction(stats->backend_hits, hits),
+				 "%lu", stats->backend_hits);
+	print_val_perc_table_row(outfile, "Dirty hits",
+				 UNIT_REQUESTS, fraction(stats->dirty_hits, hits),
+				 "%lu", stats->dirty_hits);
+	print_val_perc_table_row(outfile, "Total hits",
+				 UNIT_REQUESTS, fraction(hits, hits), "%lu", hits);
+
+	print_val_perc_table_section(outfile, "Clean hits from cache",
+				     UNIT_BLOCKS,
+				     fraction(stats->cache_hit_bytes, hit_bytes),
+				     "%lu", bytes_to_4k(stats->cache_hit_bytes));
+	print_val_perc_table_row(outfile, "Clean hits from backend",
+				 UNIT_BLOCKS,
+				 fraction(stats->backend_hit_bytes, hit_bytes),
+				 "%lu", bytes_to_4k(stats->backend_hit_bytes));
+
+	print_val_perc_table_section(outfile, "Reads served by cache",
+				     UNIT_BLOCKS, fraction(stats->cache_bytes, bytes),
+				     "%lu", bytes_to_4k(stats->cache_bytes));
+	print_val_perc_table_row(outfile, "Reads served by backend",
+				 UNIT_BLOCKS, fraction(stats->backend_bytes, bytes),
+				 "%lu", bytes_to_4k(stats->backend_bytes));
+
+	/* Split ratios are in 0-10000 scale, same as the percent column */
+	print_val_perc_table_section(outfile, "Target split ratio", "%",
+				     stats->target_ratio, "%lu.%02lu",
+				     stats->target_ratio / 100,
+				     stats->target_ratio % 100);
+	print_val_perc_table_row(outfile, "Achieved split ratio", "%",
+				 stats->achieved_ratio, "%lu.%02lu",
+				 stats->achieved_ratio / 100,
+				 stats->achieved_ratio % 100);
+
+	for (mode = 0; mode < KCAS_NETCAS_MODES; mode++)
+		time_us += stats->mode_time_us[mode];
+
+	print_val_perc_table_section(outfile, netcas_mode_time_names[0], "s",
+				     fraction(stats->mode_time_us[0], time_us),
+				     "%lu", stats->mode_time_us[0] / 1000000);
+	for (mode = 1; mode < KCAS_NETCAS_MODES; mode++) {
+		print_val_perc_table_row(outfile, netcas_mode_time_names[mode],
+					 "s", fraction(stats->mode_time_us[mode], time_us),
+					 "%lu", stats->mode_time_us[mode] / 1000000);
+	}
+}
+
 void cache_stats_core_counters(const struct kcas_core_info *info,
 			struct kcas_get_stats *stats,
 			unsigned int stats_filters, FILE *outfile)
@@ -406,6 +482,9 @@ void cache_stats_core_counters(const struct kcas_core_info *info,
 
 	if (stats_filters & STATS_FILTER_ERR)
 		print_err_stats(&stats->errors, outfile);
+
+	if (stats_filters & STATS_FILTER_NETCAS)
+		print_netcas_stats(&stats->netcas, outfile);
 }
 
 static void print_stats_ioclass_conf(const struct kcas_io_class* io_class,
@@ -625,6 +704,10 @@ void cache_stats_counters(struct kcas_get_stats *cache_stats, FILE *outfile,
 	/* Totals for error stats. */
 	if (stats_filters & STATS_FILTER_ERR)
 		print_err_stats(&cache_stats->errors, outfile);
+
+	/* Totals for netCAS stats. */
+	if (stats_filters & STATS_FILTER_NETCAS)
+		print_netcas_stats(&cache_stats->netcas, outfile);
 }
 
 static int cache_stats(int ctrl_fd, const struct kcas_cache_info *cache_info,
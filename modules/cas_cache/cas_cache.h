@@ -50,15 +50,25 @@ enum {
 };
 
 struct cas_classifier;
+struct netcas_splitter;
+struct cas_thread_info;
+struct cas_backend_throttle;
+struct cas_queue_map;
+struct dentry;
 
 struct cache_priv {
 	uint64_t core_id_bitmap[DIV_ROUND_UP(OCF_CORE_MAX, 8*sizeof(uint64_t))];
 	struct cas_classifier *classifier;
+	struct netcas_splitter *netcas;
+	struct cas_thread_info *netcas_thread;
+	struct cas_backend_throttle *backend_throttle;
+	struct dentry *debugfs_dir;
 	struct _cache_mngt_stop_context *stop_context;
 	atomic_t flush_interrupt_enabled;
 	ocf_queue_t mngt_queue;
 	void *attach_context;
 	bool cache_exp_obj_initialized;
+	struct cas_queue_map *queue_map;
 	ocf_queue_t io_queues[];
 };
 
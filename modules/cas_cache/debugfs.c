@@ -0,0 +1,322 @@
+/*
+* Copyright(c) 2012-2021 Intel Corporation
+* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include "cas_cache.h"
+#include "debugfs.h"
+#include "threads.h"
+#include "src/ocf/engine/netCAS_splitter.h"
+
+/*
+ * Per-cache readout. Every cache serving IO gets a directory with
+ * "io_batches" file listing batches of IO submitted to each IO queue
+ * within a plug, IO submitted outside of one counts as a batch of one.
+ *
+ * netCAS readout. Caches with netCAS splitter also get "netcas_cpu_split"
+ * file listing hits routed by each CPU and "netcas_targets" file listing
+ * backend read targets of each core. Writing "<core id> <MiB/s> ..." to
+ * the latter sets targets of a core, "<core id>" alone drops them. Target
+ * throughput and latency stay zero until the cache engine selects targets
+ * and accounts their completions. Caches with a trace ring also get binary
+ * "netcas_trace" file and "netcas_trace_sampling" attribute. Each open trace
+ * file is an independent reader, which starts at the oldest record held,
+ * gets a header record first and sees EOF once it caught up.
+ */
+
+#define CAS_DEBUGFS_DIR "opencas"
+
+/* Records copied out per read call */
+#define NETCAS_TRACE_READ_CHUNK \
+	(PAGE_SIZE / sizeof(struct netcas_trace_record))
+
+static struct dentry *cas_debugfs_root;
+
+struct netcas_trace_reader {
+	struct netcas_splitter *splitter;
+	uint64_t seq;
+	bool header_sent;
+	struct netcas_trace_record records[NETCAS_TRACE_READ_CHUNK];
+};
+
+static int netcas_trace_open(struct inode *inode, struct file *file)
+{
+	struct netcas_trace_reader *reader;
+
+	reader = kzalloc(sizeof(*reader), GFP_KERNEL);
+	if (!reader)
+		return -ENOMEM;
+
+	reader->splitter = inode->i_private;
+	file->private_data = reader;
+
+	return nonseekable_open(inode, file);
+}
+
+static int netcas_trace_release(struct inode *inode, struct file *file)
+{
+	kfree(file->private_data);
+	return 0;
+}
+
+static ssize_t netcas_trace_read_file(struct file *file, char __user *buf,
+		size_t len, loff_t *ppos)
+{
+	struct netcas_trace_reader *reader = file->private_data;
+	size_t record_size = sizeof(reader->records[0]);
+	uint32_t count = min_t(size_t, len / record_size,
+			NETCAS_TRACE_READ_CHUNK);
+	uint32_t copied = 0;
+
+	if (!count)
+		return -EINVAL;
+
+	if (!reader->header_sent) {
+		netcas_trace_get_header(reader->splitter, &reader->records[0]);
+		reader->header_sent = true;
+		copied = 1;
+	}
+
+	copied += netcas_trace_read(reader->splitter, &reader->seq,
+			&reader->records[copied], count - copied);
+
+	if (copy_to_user(buf, reader->records, copied * record_size))
+		return -EFAULT;
+
+	*ppos += copied * record_size;
+	return copied * record_size;
+}
+
+static const struct file_operations netcas_trace_fops = {
+	.owner = THIS_MODULE,
+	.open = netcas_trace_open,
+	.release = netcas_trace_release,
+	.read = netcas_trace_read_file,
+	.llseek = no_llseek,
+};
+
+static int netcas_trace_sampling_get(void *data, u64 *val)
+{
+	*val = netcas_trace_get_sampling(data);
+	return 0;
+}
+
+static int netcas_trace_sampling_set(void *data, u64 val)
+{
+	if (val > U32_MAX)
+		return -EINVAL;
+
+	netcas_trace_set_sampling(data, val);
+	return 0;
+}
+
+DEFINE_SIMPLE_ATTRIBUTE(netcas_trace_sampling_fops, netcas_trace_sampling_get,
+		netcas_trace_sampling_set, "%llu\n");
+
+static int netcas_cpu_split_show(struct seq_file *m, void *v)
+{
+	struct netcas_splitter *splitter = m->private;
+	uint64_t cache_hits, backend_hits;
+	uint32_t cpu;
+
+	seq_puts(m, "cpu cache_hits backend_hits achieved_ratio\n");
+
+	for (cpu = 0; cpu < num_online_cpus(); cpu++) {
+		netcas_get_cpu_split_counters(splitter, cpu, &cache_hits,
+				&backend_hits);
+		seq_printf(m, "%u %llu %llu %llu\n", cpu, cache_hits,
+				backend_hits, cache_hits + backend_hits ?
+				div64_u64(cache_hits * 10000,
+					cache_hits + backend_hits) : 10000);
+	}
+
+	return 0;
+}
+
+static int netcas_cpu_split_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, netcas_cpu_split_show, inode->i_private);
+}
+
+static const struct file_operations netcas_cpu_split_fops = {
+	.owner = THIS_MODULE,
+	.open = netcas_cpu_split_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int netcas_targets_show(struct seq_file *m, void *v)
+{
+	struct netcas_splitter *splitter = m->private;
+	struct netcas_target_stats stats[NETCAS_TARGET_MAX];
+	ocf_core_id_t core_id;
+	uint32_t count, i;
+
+	seq_puts(m, "core target bandwidth weight throughput latency "
+			"latency_reference congested\n");
+
+	for (core_id = 0; core_id < OCF_CORE_MAX; core_id++) {
+		count = netcas_get_targets(splitter, core_id, stats);
+		for (i = 0; i < count; i++) {
+			seq_printf(m, "%u %u %u %u %llu %llu %llu %u\n",
+					core_id, i, stats[i].bandwidth,
+					stats[i].weight, stats[i].throughput,
+					stats[i].latency,
+					stats[i].latency_reference,
+					stats[i].congested);
+		}
+	}
+
+	return 0;
+}
+
+static int netcas_targets_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, netcas_targets_show, inode->i_private);
+}
+
+static ssize_t netcas_targets_write(struct file *file,
+		const char __user *ubuf, size_t len, loff_t *ppos)
+{
+	struct seq_file *m = file->private_data;
+	uint32_t bandwidth[NETCAS_TARGET_MAX];
+	char buf[128], *cursor = buf, *token;
+	uint32_t core_id, count = 0;
+	int result;
+
+	if (len >= sizeof(buf))
+		return -EINVAL;
+	if (copy_from_user(buf, ubuf, len))
+		return -EFAULT;
+	buf[len] = '\0';
+
+	token = strsep(&cursor, " \t\n");
+	if (!token || kstrtou32(token, 10, &core_id) || core_id >= OCF_CORE_MAX)
+		return -EINVAL;
+
+	while ((token = strsep(&cursor, " \t\n"))) {
+		if (!*token)
+			continue;
+		if (count == NETCAS_TARGET_MAX)
+			return -EINVAL;
+		if (kstrtou32(token, 10, &bandwidth[count++]))
+			return -EINVAL;
+	}
+
+	result = netcas_set_targets(m->private, core_id, count, bandwidth);
+	if (result)
+		return -EINVAL;
+
+	return len;
+}
+
+static const struct file_operations netcas_targets_fops = {
+	.owner = THIS_MODULE,
+	.open = netcas_targets_open,
+	.read = seq_read,
+	.write = netcas_targets_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int io_batches_show(struct seq_file *m, void *v)
+{
+	ocf_cache_t cache = m->private;
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+	uint64_t batches, ios;
+	uint32_t cpu;
+
+	/* Queues are gone once the cache stops, which holds the lock */
+	if (ocf_mngt_cache_read_trylock(cache))
+		return -EBUSY;
+
+	seq_puts(m, "queue batches ios\n");
+
+	for (cpu = 0; cpu < num_online_cpus(); cpu++) {
+		batches = 0;
+		ios = 0;
+		cas_queue_get_batch_stats(cache_priv->io_queues[cpu],
+				&batches, &ios);
+		seq_printf(m, "%u %llu %llu\n", cpu, batches, ios);
+	}
+
+	ocf_mngt_cache_read_unlock(cache);
+
+	return 0;
+}
+
+static int io_batches_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, io_batches_show, inode->i_private);
+}
+
+static const struct file_operations io_batches_fops = {
+	.owner = THIS_MODULE,
+	.open = io_batches_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+void cas_debugfs_add_cache(ocf_cache_t cache)
+{
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+	struct dentry *dir;
+
+	if (!cas_debugfs_root)
+		return;
+
+	dir = debugfs_create_dir(ocf_cache_get_name(cache), cas_debugfs_root);
+	if (IS_ERR_OR_NULL(dir))
+		return;
+
+	debugfs_create_file("io_batches", S_IRUSR, dir, cache,
+			&io_batches_fops);
+
+	cache_priv->debugfs_dir = dir;
+
+	if (!cache_priv->netcas)
+		return;
+
+	debugfs_create_file("netcas_cpu_split", S_IRUSR, dir,
+			cache_priv->netcas, &netcas_cpu_split_fops);
+	debugfs_create_file("netcas_targets", S_IRUSR | S_IWUSR, dir,
+			cache_priv->netcas, &netcas_targets_fops);
+
+	if (netcas_trace_enabled(cache_priv->netcas)) {
+		debugfs_create_file("netcas_trace", S_IRUSR, dir,
+				cache_priv->netcas, &netcas_trace_fops);
+		debugfs_create_file("netcas_trace_sampling", S_IRUSR | S_IWUSR,
+				dir, cache_priv->netcas,
+				&netcas_trace_sampling_fops);
+	}
+}
+
+void cas_debugfs_remove_cache(ocf_cache_t cache)
+{
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+
+	/* Waits for readers in progress, splitter may be freed afterwards */
+	debugfs_remove_recursive(cache_priv->debugfs_dir);
+	cache_priv->debugfs_dir = NULL;
+}
+
+int __init cas_debugfs_init(void)
+{
+	cas_debugfs_root = debugfs_create_dir(CAS_DEBUGFS_DIR, NULL);
+
+	/* Tracing is a debug aid, go on without it */
+	if (IS_ERR(cas_debugfs_root))
+		cas_debugfs_root = NULL;
+
+	return 0;
+}
+
+void cas_debugfs_deinit(void)
+{
+	debugfs_remove_recursive(cas_debugfs_root);
+	cas_debugfs_root = NULL;
+}
@@ -0,0 +1,17 @@
+/*
+* Copyright(c) 2012-2021 Intel Corporation
+* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef __CAS_DEBUGFS_H__
+#define __CAS_DEBUGFS_H__
+
+#include "ocf/ocf.h"
+
+int __init cas_debugfs_init(void);
+void cas_debugfs_deinit(void);
+
+void cas_debugfs_add_cache(ocf_cache_t cache);
+void cas_debugfs_remove_cache(ocf_cache_t cache);
+
+#endif /* __CAS_DEBUGFS_H__ */
@@ -5,12 +5,16 @@
 
 #include "cas_cache.h"
 #include "threads.h"
+#include "src/ocf/engine/netCAS_splitter.h"
+#include "debugfs.h"
+#include "queue_map.h"
 
 extern u32 max_writeback_queue_size;
 extern u32 writeback_queue_unblock_size;
 extern u32 unaligned_io;
 extern u32 seq_cut_off_mb;
 extern u32 use_io_scheduler;
+extern u32 netcas_trace_entries;
 
 struct cas_lazy_thread {
 	char name[64];
@@ -564,6 +568,8 @@ static void _cache_mngt_cache_priv_deinit(ocf_cache_t cache)
 {
 	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
 
+	cas_queue_map_deinit(cache);
+
 	kfree(cache_priv->stop_context);
 
 	vfree(cache_priv);
@@ -590,6 +596,15 @@ static int exit_instance_finish(void *data)
 	if (!ocf_cache_is_standby(ctx->cache))
 		cas_cls_deinit(ctx->cache);
 
+	if (cache_priv->netcas) {
+		cas_debugfs_remove_cache(ctx->cache);
+		cas_backend_throttle_deinit(cache_priv->backend_throttle);
+		cas_stop_netcas_thread(ctx->cache);
+		netcas_splitter_deinit(cache_priv->netcas);
+		cache_priv->netcas = NULL;
+	}
+
+	cas_queue_map_deinit(ctx->cache);
 	vfree(cache_priv);
 
 	ocf_mngt_cache_unlock(ctx->cache);
@@ -617,6 +632,7 @@ struct _cache_mngt_attach_context {
 	struct {
 		bool priv_inited:1;
 		bool cls_inited:1;
+		bool netcas_inited:1;
 	};
 };
 
@@ -635,6 +651,14 @@ static int cache_start_rollback(void *data)
 	if (ctx->priv_inited) {
 		cache_priv = ocf_cache_get_priv(cache);
 		mngt_queue = cache_priv->mngt_queue;
+		if (ctx->netcas_inited) {
+			cas_debugfs_remove_cache(cache);
+			cas_backend_throttle_deinit(
+					cache_priv->backend_throttle);
+			cas_stop_netcas_thread(cache);
+			netcas_splitter_deinit(cache_priv->netcas);
+			cache_priv->netcas = NULL;
+		}
 		_cache_mngt_cache_priv_deinit(cache);
 	}
 
@@ -1012,6 +1036,34 @@ int cache_mngt_get_promotion_policy(ocf_cache_t cache, uint32_t *type)
 	return result;
 }
 
+int cache_mngt_set_io_queue_policy(ocf_cache_t cache, uint32_t policy)
+{
+	int result;
+
+	result = _cache_mngt_read_lock_sync(cache);
+	if (result)
+		return result;
+
+	result = cas_queue_map_set_policy(cache, policy);
+
+	ocf_mngt_cache_read_unlock(cache);
+	return result;
+}
+
+int cache_mngt_get_io_queue_policy(ocf_cache_t cache, uint32_t *policy)
+{
+	int result;
+
+	result = _cache_mngt_read_lock_sync(cache);
+	if (result)
+		return result;
+
+	*policy = cas_queue_map_get_policy(cache);
+
+	ocf_mngt_cache_read_unlock(cache);
+	return 0;
+}
+
 int cache_mngt_set_promotion_param(ocf_cache_t cache, ocf_promotion_t type,
 		uint32_t param_id, uint32_t param_value)
 {
@@ -1640,6 +1692,15 @@ put:
 	return result;
 }
 
+static void _cache_mngt_reset_netcas_stats(ocf_cache_t cache,
+		ocf_core_id_t core_id)
+{
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+
+	if (cache_priv && cache_priv->netcas)
+		netcas_reset_core_stats(cache_priv->netcas, core_id);
+}
+
 int cache_mngt_reset_stats(const char *cache_name, size_t cache_name_len,
 				const char *core_name, size_t core_name_len)
 {
@@ -1665,8 +1726,11 @@ int cache_mngt_reset_stats(const char *cache_name, size_t cache_name_len,
 			goto out;
 
 		ocf_core_stats_initialize(core);
+		_cache_mngt_reset_netcas_stats(cache, ocf_core_get_id(core));
 	} else {
 		result = ocf_core_stats_initialize_all(cache);
+		if (!result)
+			_cache_mngt_reset_netcas_stats(cache, OCF_CORE_ID_INVALID);
 	}
 
 out:
@@ -1685,6 +1749,46 @@ static inline void io_class_info2cfg(ocf_part_id_t part_id,
 	cfg->max_size = info->max_size;
 }
 
+static int _cache_mngt_check_netcas_bounds(struct kcas_io_classes *cfg)
+{
+	ocf_part_id_t class_id;
+
+	for (class_id = 0; class_id < OCF_USER_IO_CLASS_MAX; class_id++) {
+		if (!cfg->info[class_id].name[0])
+			continue;
+
+		if (cfg->netcas[class_id].min_split >
+				cfg->netcas[class_id].max_split ||
+				cfg->netcas[class_id].max_split > SPLIT_RATIO_MAX)
+			return -OCF_ERR_INVAL;
+	}
+
+	return 0;
+}
+
+static void _cache_mngt_set_netcas_bounds(ocf_cache_t cache,
+		struct kcas_io_classes *cfg)
+{
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+	ocf_part_id_t class_id;
+
+	if (!cache_priv || !cache_priv->netcas)
+		return;
+
+	for (class_id = 0; class_id < OCF_USER_IO_CLASS_MAX; class_id++) {
+		/* Removed classes go back to unbounded split */
+		if (!cfg->info[class_id].name[0]) {
+			netcas_set_io_class_bounds(cache_priv->netcas, class_id,
+					SPLIT_RATIO_MIN, SPLIT_RATIO_MAX);
+			continue;
+		}
+
+		netcas_set_io_class_bounds(cache_priv->netcas, class_id,
+				cfg->netcas[class_id].min_split,
+				cfg->netcas[class_id].max_split);
+	}
+}
+
 int cache_mngt_set_partitions(const char *cache_name, size_t name_len,
 		struct kcas_io_classes *cfg)
 {
@@ -1699,6 +1803,10 @@ int cache_mngt_set_partitions(const char *cache_name, size_t name_len,
 	if (!io_class_cfg)
 		return -OCF_ERR_NO_MEM;
 
+	result = _cache_mngt_check_netcas_bounds(cfg);
+	if (result)
+		goto out_get;
+
 	for (class_id = 0; class_id < OCF_USER_IO_CLASS_MAX; class_id++) {
 		io_class_cfg->config[class_id].class_id = class_id;
 
@@ -1746,6 +1854,8 @@ int cache_mngt_set_partitions(const char *cache_name, size_t name_len,
 	for (class_id = 0; class_id < OCF_USER_IO_CLASS_MAX; class_id++)
 		cas_cls_rule_apply(cache, class_id, cls_rule[class_id]);
 
+	_cache_mngt_set_netcas_bounds(cache, cfg);
+
 out_configure:
 	ocf_mngt_cache_unlock(cache);
 out_cls:
@@ -2045,6 +2155,8 @@ static void init_instance_complete(struct _cache_mngt_attach_context *ctx,
 	if (cas_bdev_whole(bdev) == bdev)
 		cas_reread_partitions(bdev);
 
+	cas_queue_map_set_device(cache, bdev);
+
 	/* Set other back information */
 	name = block_dev_get_elevator_name(
 			casdsk_disk_get_queue(bd_cache_obj->dsk));
@@ -2091,6 +2203,7 @@ static int _cache_mngt_cache_priv_init(ocf_cache_t cache)
 {
 	struct cache_priv *cache_priv;
 	uint32_t cpus_no = num_online_cpus();
+	int result;
 
 	cache_priv = vzalloc(sizeof(*cache_priv) +
 			cpus_no * sizeof(*cache_priv->io_queues));
@@ -2108,6 +2221,14 @@ static int _cache_mngt_cache_priv_init(ocf_cache_t cache)
 
 	ocf_cache_set_priv(cache, cache_priv);
 
+	result = cas_queue_map_init(cache);
+	if (result) {
+		ocf_cache_set_priv(cache, NULL);
+		kfree(cache_priv->stop_context);
+		vfree(cache_priv);
+		return result;
+	}
+
 	return 0;
 }
 
@@ -2202,6 +2323,39 @@ static int _cache_start_finalize(ocf_cache_t cache, int init_mode,
 			return result;
 		}
 		ctx->cls_inited = true;
+
+		result = netcas_splitter_init(cache, &cache_priv->netcas);
+		if (result) {
+			ctx->ocf_start_error = result;
+			return result;
+		}
+
+		/* Tracing is optional, cache runs without it on failure.
+		 * The ring has to be in place before the monitor starts. */
+		if (netcas_trace_entries)
+			netcas_trace_init(cache_priv->netcas,
+					netcas_trace_entries);
+
+		result = cas_create_netcas_thread(cache);
+		if (result) {
+			netcas_splitter_deinit(cache_priv->netcas);
+			cache_priv->netcas = NULL;
+			ctx->ocf_start_error = result;
+			return result;
+		}
+
+		result = cas_backend_throttle_init(cache, cache_priv->netcas,
+				&cache_priv->backend_throttle);
+		if (result) {
+			cas_stop_netcas_thread(cache);
+			netcas_splitter_deinit(cache_priv->netcas);
+			cache_priv->netcas = NULL;
+			ctx->ocf_start_error = result;
+			return result;
+		}
+		ctx->netcas_inited = true;
+
+		cas_debugfs_add_cache(cache);
 	}
 
 	if (activate)
@@ -2794,6 +2948,65 @@ int cache_mngt_get_seq_cutoff_promotion_count(ocf_core_t core,
 	return result;
 }
 
+static int _cache_mngt_set_io_split_size_visitor(ocf_core_t core, void *cntx)
+{
+	return kcas_core_set_io_split_size(core, *(uint32_t *)cntx);
+}
+
+/**
+ * @brief Override max size of IO exported object bios are split into
+ * @param[in] cache cache to which the change pertains
+ * @param[in] core core to which the change pertains
+ * or NULL for setting value for all cores attached to specified cache
+ * @param[in] size split size in bytes, 0 restores device derived size
+ * @return exit code of successful completion is 0;
+ * nonzero exit code means failure
+ */
+
+int cache_mngt_set_io_split_size(ocf_cache_t cache, ocf_core_t core,
+		uint32_t size)
+{
+	int result;
+
+	result = _cache_mngt_read_lock_sync(cache);
+	if (result)
+		return result;
+
+	if (core) {
+		result = kcas_core_set_io_split_size(core, size);
+	} else {
+		result = ocf_core_visit(cache,
+				_cache_mngt_set_io_split_size_visitor,
+				&size, true);
+	}
+
+	ocf_mngt_cache_read_unlock(cache);
+	return result;
+}
+
+/**
+ * @brief Get effective max size of IO exported object bios are split into
+ * @param[in] core OCF core
+ * @param[out] size split size in bytes
+ * @return exit code of successful completion is 0;
+ * nonzero exit code means failure
+ */
+
+int cache_mngt_get_io_split_size(ocf_core_t core, uint32_t *size)
+{
+	ocf_cache_t cache = ocf_core_get_cache(core);
+	int result;
+
+	result = _cache_mngt_read_lock_sync(cache);
+	if (result)
+		return result;
+
+	*size = kcas_core_get_io_split_size(core);
+
+	ocf_mngt_cache_read_unlock(cache);
+	return 0;
+}
+
 static int _cache_flush_with_lock(ocf_cache_t cache)
 {
 	int result = 0;
@@ -3041,6 +3254,35 @@ int cache_mngt_interrupt_flushing(const char *cache_name, size_t name_len)
 
 }
 
+static void _cache_mngt_get_netcas_stats(ocf_cache_t cache,
+		ocf_core_id_t core_id, struct kcas_netcas_stats *netcas)
+{
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+	struct netcas_core_stats core_stats;
+	int mode;
+
+	memset(netcas, 0, sizeof(*netcas));
+	if (!cache_priv || !cache_priv->netcas)
+		return;
+
+	netcas_get_core_stats(cache_priv->netcas, core_id, &core_stats);
+
+	netcas->enabled = true;
+	netcas->cache_hits = core_stats.hits[NETCAS_PATH_CACHE];
+	netcas->backend_hits = core_stats.hits[NETCAS_PATH_BACKEND];
+	netcas->dirty_hits = core_stats.dirty_hits;
+	netcas->cache_hit_bytes = core_stats.hit_bytes[NETCAS_PATH_CACHE];
+	netcas->backend_hit_bytes = core_stats.hit_bytes[NETCAS_PATH_BACKEND];
+	netcas->cache_bytes = core_stats.completed_bytes[NETCAS_PATH_CACHE];
+	netcas->backend_bytes = core_stats.completed_bytes[NETCAS_PATH_BACKEND];
+	netcas->achieved_ratio = core_stats.achieved_ratio;
+	netcas->target_ratio = core_stats.target_ratio;
+
+	BUILD_BUG_ON(KCAS_NETCAS_MODES != NETCAS_MODE_MAX);
+	for (mode = 0; mode < NETCAS_MODE_MAX; mode++)
+		netcas->mode_time_us[mode] = core_stats.mode_time_us[mode];
+}
+
 int cache_mngt_get_stats(struct kcas_get_stats *stats)
 {
 	int result;
@@ -3062,6 +3304,9 @@ int cache_mngt_get_stats(struct kcas_get_stats *stats)
 		if (result)
 			goto unlock;
 
+		_cache_mngt_get_netcas_stats(cache, OCF_CORE_ID_INVALID,
+				&stats->netcas);
+
 	} else if (stats->part_id == OCF_IO_CLASS_INVALID) {
 		result = get_core_by_id(cache, stats->core_id, &core);
 		if (result)
@@ -3072,6 +3317,9 @@ int cache_mngt_get_stats(struct kcas_get_stats *stats)
 		if (result)
 			goto unlock;
 
+		_cache_mngt_get_netcas_stats(cache, stats->core_id,
+				&stats->netcas);
+
 	} else {
 		if (stats->core_id == OCF_CORE_ID_INVALID) {
 			result = ocf_stats_collect_part_cache(cache, stats->part_id,
@@ -3144,6 +3392,7 @@ int cache_mngt_get_io_class_info(struct kcas_io_class *part)
 	int result;
 	uint16_t cache_id = part->cache_id;
 	uint32_t io_class_id = part->class_id;
+	struct cache_priv *cache_priv;
 	ocf_cache_t cache;
 
 	result = mngt_get_cache_by_id(cas_ctx, cache_id, &cache);
@@ -3160,6 +3409,158 @@ int cache_mngt_get_io_class_info(struct kcas_io_class *part)
 	if (result)
 		goto end;
 
+	part->netcas.min_split = SPLIT_RATIO_MIN;
+	part->netcas.max_split = SPLIT_RATIO_MAX;
+	cache_priv = ocf_cache_get_priv(cache);
+	if (cache_priv && cache_priv->netcas) {
+		netcas_get_io_class_bounds(cache_priv->netcas, io_class_id,
+				&part->netcas.min_split,
+				&part->netcas.max_split);
+	}
+
+end:
+	ocf_mngt_cache_read_unlock(cache);
+	ocf_mngt_cache_put(cache);
+	return result;
+}
+
+static int _cache_mngt_netcas_set(struct netcas_splitter *splitter,
+		struct kcas_netcas *cmd)
+{
+	struct netcas_params params;
+	int result;
+
+	if (cmd->set_flags & KCAS_NETCAS_SET_POLICY &&
+			cmd->policy >= NETCAS_POLICY_MAX)
+		return -OCF_ERR_INVAL;
+
+	if ((cmd->set_flags & KCAS_NETCAS_SET_PIN) &&
+			(cmd->set_flags & KCAS_NETCAS_SET_UNPIN))
+		return -OCF_ERR_INVAL;
+
+	netcas_get_params(splitter, &params);
+
+	if (cmd->set_flags & KCAS_NETCAS_SET_INTERVAL)
+		params.monitor_interval_ms = cmd->monitor_interval_ms;
+	if (cmd->set_flags & KCAS_NETCAS_SET_LOG_INTERVAL)
+		params.log_interval_ms = cmd->log_interval_ms;
+	if (cmd->set_flags & KCAS_NETCAS_SET_THRESHOLDS) {
+		params.latency_congestion_threshold =
+			cmd->latency_congestion_threshold;
+		params.latency_recovery_threshold =
+			cmd->latency_recovery_threshold;
+	}
+	if (cmd->set_flags & KCAS_NETCAS_SET_PIN)
+		params.pinned_ratio = cmd->pinned_ratio;
+	if (cmd->set_flags & KCAS_NETCAS_SET_UNPIN)
+		params.pinned_ratio = NETCAS_RATIO_UNPINNED;
+	if (cmd->set_flags & KCAS_NETCAS_SET_HEDGE_BUDGET)
+		params.hedge_budget_permil = cmd->hedge_budget;
+	if (cmd->set_flags & KCAS_NETCAS_SET_HEDGE_PERCENTILE)
+		params.hedge_percentile = cmd->hedge_percentile;
+
+	result = netcas_set_params(splitter, &params);
+	if (result)
+		return result;
+
+	if (cmd->set_flags & KCAS_NETCAS_SET_POLICY)
+		netcas_set_policy(splitter, cmd->policy);
+	if (cmd->set_flags & KCAS_NETCAS_SET_P99_TARGET)
+		netcas_set_p99_target(splitter, cmd->p99_target_ns);
+	if (cmd->set_flags & KCAS_NETCAS_SET_RESET)
+		netcas_reset_splitter(splitter);
+
+	return 0;
+}
+
+static void _cache_mngt_netcas_get(struct netcas_splitter *splitter,
+		struct kcas_netcas *cmd)
+{
+	struct netcas_params params;
+	struct netcas_telemetry telemetry;
+	int size;
+
+	netcas_get_params(splitter, &params);
+	netcas_get_telemetry(splitter, &telemetry);
+
+	cmd->monitor_interval_ms = params.monitor_interval_ms;
+	cmd->log_interval_ms = params.log_interval_ms;
+	cmd->latency_congestion_threshold =
+		params.latency_congestion_threshold;
+	cmd->latency_recovery_threshold = params.latency_recovery_threshold;
+	cmd->pinned_ratio = params.pinned_ratio;
+	cmd->policy = netcas_get_policy(splitter);
+	cmd->p99_target_ns = netcas_get_p99_target(splitter);
+	cmd->hedge_budget = params.hedge_budget_permil;
+	cmd->hedge_percentile = params.hedge_percentile;
+
+	cmd->mode = telemetry.mode;
+	cmd->active_policy = telemetry.policy;
+	cmd->optimal_ratio = telemetry.optimal_ratio;
+	for (size = 0; size < kcas_netcas_size_max; size++)
+		cmd->published_ratio[size] = telemetry.published_ratio[size];
+	cmd->achieved_ratio = telemetry.achieved_ratio;
+	cmd->dirty_hit_ratio = telemetry.dirty_hit_ratio;
+	cmd->rdma_throughput = telemetry.rdma_throughput_average;
+	cmd->max_rdma_throughput = telemetry.max_rdma_throughput_average;
+	cmd->rdma_latency = telemetry.rdma_latency_average;
+	cmd->min_rdma_latency = telemetry.min_rdma_latency_average;
+	cmd->bw_drop_permil = telemetry.bw_drop_permil;
+	cmd->latency_increase_permil = telemetry.latency_increase_permil;
+	cmd->cache_throughput = telemetry.path_throughput[NETCAS_PATH_CACHE];
+	cmd->backend_throughput =
+		telemetry.path_throughput[NETCAS_PATH_BACKEND];
+	cmd->cache_p99_ns = telemetry.path_p99[NETCAS_PATH_CACHE];
+	cmd->backend_p99_ns = telemetry.path_p99[NETCAS_PATH_BACKEND];
+	cmd->io_depth = telemetry.io_depth;
+	cmd->numjob = telemetry.numjob;
+	cmd->tail_bias = telemetry.tail_bias;
+	cmd->cache_hedge_delay_ns = telemetry.hedge_delay[NETCAS_PATH_CACHE];
+	cmd->backend_hedge_delay_ns =
+		telemetry.hedge_delay[NETCAS_PATH_BACKEND];
+	cmd->hedges = telemetry.hedges;
+	cmd->hedge_wins = telemetry.hedge_wins;
+	cmd->backend_budget = telemetry.backend_budget;
+	cmd->engine_hooks = telemetry.engine_hooks;
+}
+
+int cache_mngt_netcas(struct kcas_netcas *cmd)
+{
+	struct cache_priv *cache_priv;
+	ocf_cache_t cache;
+	int result;
+
+	result = mngt_get_cache_by_id(cas_ctx, cmd->cache_id, &cache);
+	if (result)
+		return result;
+
+	result = _cache_mngt_read_lock_sync(cache);
+	if (result) {
+		ocf_mngt_cache_put(cache);
+		return result;
+	}
+
+	if (ocf_cache_is_standby(cache)) {
+		result = -OCF_ERR_CACHE_STANDBY;
+		goto end;
+	}
+
+	cache_priv = ocf_cache_get_priv(cache);
+	if (!cache_priv || !cache_priv->netcas) {
+		result = -OCF_ERR_INVAL;
+		goto end;
+	}
+
+	if (cmd->set_flags) {
+		result = _cache_mngt_netcas_set(cache_priv->netcas, cmd);
+		if (result)
+			goto end;
+	}
+
+	_cache_mngt_netcas_get(cache_priv->netcas, cmd);
+	cmd->throttled_ios = cas_backend_throttle_get_deferred(
+			cache_priv->backend_throttle);
+
 end:
 	ocf_mngt_cache_read_unlock(cache);
 	ocf_mngt_cache_put(cache);
@@ -3258,6 +3659,10 @@ int cache_mngt_set_core_params(struct kcas_set_core_param *info)
 		result = cache_mngt_set_seq_cutoff_promotion_count(cache,
 				core, info->param_value);
 		break;
+	case core_param_io_split_max_size:
+		result = cache_mngt_set_io_split_size(cache, core,
+				info->param_value);
+		break;
 	default:
 		result = -EINVAL;
 	}
@@ -3294,6 +3699,10 @@ int cache_mngt_get_core_params(struct kcas_get_core_param *info)
 		result = cache_mngt_get_seq_cutoff_promotion_count(core,
 				&info->param_value);
 		break;
+	case core_param_io_split_max_size:
+		result = cache_mngt_get_io_split_size(core,
+				&info->param_value);
+		break;
 	default:
 		result = -EINVAL;
 	}
@@ -3360,6 +3769,10 @@ int cache_mngt_set_cache_params(struct kcas_set_cache_param *info)
 		result = cache_mngt_set_promotion_param(cache, ocf_promotion_nhit,
 				ocf_nhit_trigger_threshold, info->param_value);
 		break;
+	case cache_param_io_queue_policy:
+		result = cache_mngt_set_io_queue_policy(cache,
+				info->param_value);
+		break;
 	default:
 		result = -EINVAL;
 	}
@@ -3424,6 +3837,10 @@ int cache_mngt_get_cache_params(struct kcas_get_cache_param *info)
 		result = cache_mngt_get_promotion_param(cache, ocf_promotion_nhit,
 				ocf_nhit_trigger_threshold, &info->param_value);
 		break;
+	case cache_param_io_queue_policy:
+		result = cache_mngt_get_io_queue_policy(cache,
+				&info->param_value);
+		break;
 	default:
 		result = -EINVAL;
 	}
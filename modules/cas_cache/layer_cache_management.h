@@ -28,6 +28,10 @@ int cache_mngt_set_promotion_param(ocf_cache_t cache, ocf_promotion_t type,
 int cache_mngt_get_promotion_param(ocf_cache_t cache, ocf_promotion_t type,
 		uint32_t param_id, uint32_t *param_value);
 
+int cache_mngt_set_io_queue_policy(ocf_cache_t cache, uint32_t policy);
+
+int cache_mngt_get_io_queue_policy(ocf_cache_t cache, uint32_t *policy);
+
 int cache_mngt_add_core_to_cache(const char *cache_name, size_t name_len,
 		struct ocf_mngt_core_config *cfg,
 		struct kcas_insert_core *cmd_info);
@@ -110,6 +114,8 @@ int cache_mngt_get_cache_params(struct kcas_get_cache_param *info);
 
 int cache_mngt_standby_detach(struct kcas_standby_detach *cmd);
 
+int cache_mngt_netcas(struct kcas_netcas *cmd);
+
 int cache_mngt_create_cache_standby_activate_cfg(
 		struct ocf_mngt_cache_standby_activate_config *cfg,
 		struct kcas_standby_activate *cmd);
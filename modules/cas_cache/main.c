@@ -4,6 +4,7 @@
 */
 
 #include "cas_cache.h"
+#include "debugfs.h"
 
 /* Layer information. */
 MODULE_AUTHOR("Intel(R) Corporation");
@@ -38,6 +39,24 @@ module_param(seq_cut_off_mb, uint, (S_IRUSR | S_IRGRP));
 MODULE_PARM_DESC(seq_cut_off_mb,
 		"Sequential cut off threshold in MiB. 0 - disable");
 
+u32 netcas_policy = 0;
+module_param(netcas_policy, uint, (S_IRUSR | S_IWUSR | S_IRGRP));
+MODULE_PARM_DESC(netcas_policy,
+		"netCAS split ratio controller, may be changed at runtime, "
+		"0 - bandwidth model formula, 1 - hill climbing");
+
+u32 netcas_p99_target_us = 0;
+module_param(netcas_p99_target_us, uint, (S_IRUSR | S_IWUSR | S_IRGRP));
+MODULE_PARM_DESC(netcas_p99_target_us,
+		"netCAS p99 read completion latency objective per path "
+		"in microseconds, may be changed at runtime. 0 - disable");
+
+u32 netcas_trace_entries = 0;
+module_param(netcas_trace_entries, uint, (S_IRUSR | S_IRGRP));
+MODULE_PARM_DESC(netcas_trace_entries,
+		"Size of per cache netCAS trace ring in records, rounded "
+		"down to power of two, exposed in debugfs. 0 - disable");
+
 /* globals */
 ocf_ctx_t cas_ctx;
 struct casdsk_functions_mapper casdisk_functions;
@@ -164,6 +183,8 @@ static int __init cas_init_module(void)
 		goto error_cas_ctx_init;
 	}
 
+	cas_debugfs_init();
+
 	printk(KERN_INFO "%s Version %s (%s)::Module loaded successfully\n",
 		OCF_PREFIX_LONG, CAS_VERSION, CAS_KERNEL);
 
@@ -181,6 +202,7 @@ static void __exit cas_exit_module(void)
 {
 	cas_ctrl_device_deinit();
 	cas_cleanup_context();
+	cas_debugfs_deinit();
 }
 
 module_exit(cas_exit_module);
@@ -300,3 +300,12 @@ void env_sort(void *base, size_t num, size_t size,
 		env_cond_resched();
 	}
 }
+
+/* *** NETCAS *** */
+
+struct netcas_splitter *env_netcas_get_splitter(struct ocf_cache *cache)
+{
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+
+	return cache_priv ? cache_priv->netcas : NULL;
+}
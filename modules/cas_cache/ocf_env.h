@@ -550,6 +550,12 @@ static inline uint64_t env_secs_to_ticks(uint64_t j)
 	return j * 1000000000UL;
 }
 
+/* Monotonic clock in ns, for measuring intervals which mustn't jump */
+static inline uint64_t env_get_monotonic_ns(void)
+{
+	return CAS_KTIME_GET_NS();
+}
+
 static inline bool env_time_after(uint64_t a, uint64_t b)
 {
 	return time_after64(a,b);
@@ -627,6 +633,14 @@ static inline uint32_t env_crc32(uint32_t crc, uint8_t const *data, size_t len)
 #define ENV_BUILD_BUG_ON(cond)		BUILD_BUG_ON(cond)
 
 
+/* *** NETCAS *** */
+
+struct ocf_cache;
+struct netcas_splitter;
+
+/* Splitter context of given cache, NULL if not initialized */
+struct netcas_splitter *env_netcas_get_splitter(struct ocf_cache *cache);
+
 /* *** EXECUTION COTNEXT *** */
 static inline unsigned env_get_execution_context(void)
 {
@@ -0,0 +1,149 @@
+/*
+* Copyright(c) 2012-2021 Intel Corporation
+* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#include "cas_cache.h"
+#include "queue_map.h"
+
+/*
+ * Mapping of submitting CPU to OCF IO queue. There is one IO queue per
+ * online CPU, with its thread bound to that CPU. Besides using the queue of
+ * submitting CPU, IO may be spread round-robin over queues of the NUMA node
+ * of submitter or, for submitters away from the cache device, over queues of
+ * the node the cache device is attached to. Queues of each node are kept in
+ * a contiguous slice of queues[].
+ */
+struct cas_queue_map {
+	uint32_t policy;
+	int device_node;
+	unsigned int __percpu *rr;
+	uint32_t *node_first;
+	uint32_t *node_count;
+	uint32_t queues[];
+};
+
+int cas_queue_map_init(ocf_cache_t cache)
+{
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+	uint32_t cpus_no = num_online_cpus();
+	struct cas_queue_map *map;
+	uint32_t i, pos = 0;
+	int node;
+
+	map = kzalloc(sizeof(*map) + cpus_no * sizeof(*map->queues),
+			GFP_KERNEL);
+	if (!map)
+		return -ENOMEM;
+
+	map->node_first = kcalloc(nr_node_ids, sizeof(*map->node_first),
+			GFP_KERNEL);
+	map->node_count = kcalloc(nr_node_ids, sizeof(*map->node_count),
+			GFP_KERNEL);
+	map->rr = alloc_percpu(unsigned int);
+	if (!map->node_first || !map->node_count || !map->rr) {
+		free_percpu(map->rr);
+		kfree(map->node_count);
+		kfree(map->node_first);
+		kfree(map);
+		return -ENOMEM;
+	}
+
+	for (node = 0; node < nr_node_ids; node++) {
+		map->node_first[node] = pos;
+		for (i = 0; i < cpus_no; i++) {
+			if (cpu_to_node(i) != node)
+				continue;
+			map->queues[pos++] = i;
+			map->node_count[node]++;
+		}
+	}
+
+	map->policy = io_queue_policy_per_cpu;
+	map->device_node = NUMA_NO_NODE;
+
+	cache_priv->queue_map = map;
+
+	return 0;
+}
+
+void cas_queue_map_deinit(ocf_cache_t cache)
+{
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+	struct cas_queue_map *map = cache_priv->queue_map;
+
+	if (!map)
+		return;
+
+	free_percpu(map->rr);
+	kfree(map->node_count);
+	kfree(map->node_first);
+	kfree(map);
+	cache_priv->queue_map = NULL;
+}
+
+void cas_queue_map_set_device(ocf_cache_t cache, struct block_device *bdev)
+{
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+	int node = cas_bdev_whole(bdev)->bd_disk->queue->node;
+
+	if (node < 0 || node >= nr_node_ids)
+		node = NUMA_NO_NODE;
+
+	WRITE_ONCE(cache_priv->queue_map->device_node, node);
+}
+
+int cas_queue_map_set_policy(ocf_cache_t cache, uint32_t policy)
+{
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+
+	if (policy >= io_queue_policy_max)
+		return -OCF_ERR_INVAL;
+
+	WRITE_ONCE(cache_priv->queue_map->policy, policy);
+
+	return 0;
+}
+
+uint32_t cas_queue_map_get_policy(ocf_cache_t cache)
+{
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+
+	return READ_ONCE(cache_priv->queue_map->policy);
+}
+
+ocf_queue_t cas_queue_map_select(ocf_cache_t cache)
+{
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+	struct cas_queue_map *map = cache_priv->queue_map;
+	ocf_queue_t queue;
+	uint32_t count, idx;
+	int cpu, node;
+
+	cpu = get_cpu();
+	queue = cache_priv->io_queues[cpu];
+
+	switch (READ_ONCE(map->policy)) {
+	case io_queue_policy_numa_node:
+		node = cpu_to_node(cpu);
+		break;
+	case io_queue_policy_device_local:
+		node = READ_ONCE(map->device_node);
+		if (node == NUMA_NO_NODE || node == cpu_to_node(cpu))
+			goto out;
+		break;
+	default:
+		goto out;
+	}
+
+	count = map->node_count[node];
+	if (count) {
+		idx = this_cpu_inc_return(*map->rr) % count;
+		queue = cache_priv->io_queues[map->queues[
+				map->node_first[node] + idx]];
+	}
+
+out:
+	put_cpu();
+	return queue;
+}
@@ -0,0 +1,23 @@
+/*
+* Copyright(c) 2012-2021 Intel Corporation
+* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef __CAS_QUEUE_MAP_H__
+#define __CAS_QUEUE_MAP_H__
+
+#include "ocf/ocf.h"
+
+struct block_device;
+
+int cas_queue_map_init(ocf_cache_t cache);
+void cas_queue_map_deinit(ocf_cache_t cache);
+
+void cas_queue_map_set_device(ocf_cache_t cache, struct block_device *bdev);
+
+int cas_queue_map_set_policy(ocf_cache_t cache, uint32_t policy);
+uint32_t cas_queue_map_get_policy(ocf_cache_t cache);
+
+ocf_queue_t cas_queue_map_select(ocf_cache_t cache);
+
+#endif /* __CAS_QUEUE_MAP_H__ */
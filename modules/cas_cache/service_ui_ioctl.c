@@ -402,6 +402,15 @@ long cas_service_ioctl_ctrl(struct file *filp, unsigned int cmd,
 
 		RETURN_CMD_RESULT(cmd_info, arg, retval);
 	}
+	case KCAS_IOCTL_NETCAS: {
+		struct kcas_netcas *cmd_info;
+
+		GET_CMD_INFO(cmd_info, arg);
+
+		retval = cache_mngt_netcas(cmd_info);
+
+		RETURN_CMD_RESULT(cmd_info, arg, retval);
+	}
 	default:
 		return -EINVAL;
 	}
@@ -5,14 +5,20 @@
 
 #include "threads.h"
 #include "cas_cache.h"
+#include "src/ocf/engine/netCAS_splitter.h"
 
 #define MAX_THREAD_NAME_SIZE 48
 
+extern u32 netcas_policy;
+extern u32 netcas_p99_target_us;
+
 struct cas_thread_info {
 	char name[MAX_THREAD_NAME_SIZE];
 	void *sync_data;
 	atomic_t stop;
 	atomic_t kicked;
+	atomic64_t batches;
+	atomic64_t batched_ios;
 	struct completion compl;
 	struct completion sync_compl;
 	wait_queue_head_t wq;
@@ -115,6 +121,64 @@ static int _cas_cleaner_thread(void *data)
 	return 0;
 }
 
+/*
+ * Sleep until stop is requested or given time passes. Monitor intervals go
+ * below a jiffy, so the timeout is kept by a high resolution timer instead
+ * of being rounded up to the scheduler tick.
+ */
+static void _cas_netcas_wait(struct cas_thread_info *info, uint32_t ms)
+{
+	ktime_t timeout = ms_to_ktime(ms);
+	DEFINE_WAIT(wait);
+
+	prepare_to_wait(&info->wq, &wait, TASK_INTERRUPTIBLE);
+	if (!atomic_read(&info->stop))
+		schedule_hrtimeout(&timeout, HRTIMER_MODE_REL);
+	finish_wait(&info->wq, &wait);
+}
+
+static int _cas_netcas_thread(void *data)
+{
+	ocf_cache_t cache = data;
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+	struct cas_thread_info *info;
+	/* Module params are pushed on change only, not to override
+	 * per cache settings made via ioctl */
+	u32 policy = U32_MAX, p99_target_us = U32_MAX;
+	uint32_t ms;
+
+	ENV_BUG_ON(!cache_priv);
+	/* complete the creation of the thread */
+	info = cache_priv->netcas_thread;
+	BUG_ON(!info);
+
+	CAS_DAEMONIZE(info->thread->comm);
+
+	complete(&info->compl);
+
+	do {
+		if (atomic_read(&info->stop))
+			break;
+
+		if (policy != READ_ONCE(netcas_policy)) {
+			policy = READ_ONCE(netcas_policy);
+			netcas_set_policy(cache_priv->netcas, policy);
+		}
+		if (p99_target_us != READ_ONCE(netcas_p99_target_us)) {
+			p99_target_us = READ_ONCE(netcas_p99_target_us);
+			netcas_set_p99_target(cache_priv->netcas,
+					(u64)p99_target_us * NSEC_PER_USEC);
+		}
+		ms = netcas_monitor_run(cache_priv->netcas);
+
+		_cas_netcas_wait(info, ms);
+	} while (true);
+
+	complete_and_exit(&info->compl, 0);
+
+	return 0;
+}
+
 static int _cas_create_thread(struct cas_thread_info **pinfo,
 		int (*threadfn)(void *), void *priv, int cpu,
 		const char *fmt, ...)
@@ -197,12 +261,88 @@ int cas_create_queue_thread(ocf_queue_t q, int cpu)
 	return result;
 }
 
+/*
+ * IOs a task submits to a queue within its plug are a batch. Kicks of the
+ * queue by that task are held back in its plug callback and wake the
+ * thread once, when the plug is flushed. Kicks by other submitters and by
+ * completions wake it at once.
+ */
+struct cas_queue_plug_cb {
+	struct blk_plug_cb cb;
+	uint32_t ios;
+	bool kicked;
+};
+
+static void cas_queue_unplug(struct blk_plug_cb *cb, bool from_schedule)
+{
+	struct cas_queue_plug_cb *plug_cb = container_of(cb,
+			struct cas_queue_plug_cb, cb);
+	struct cas_thread_info *info = ocf_queue_get_priv(cb->data);
+
+	atomic64_inc(&info->batches);
+	atomic64_add(plug_cb->ios, &info->batched_ios);
+
+	if (plug_cb->kicked)
+		wake_up(&info->wq);
+
+	kfree(plug_cb);
+}
+
+/* Batch of the queue open in the plug of the current task, if any */
+static struct cas_queue_plug_cb *cas_queue_plugged(ocf_queue_t q)
+{
+	struct blk_plug *plug = current->plug;
+	struct blk_plug_cb *cb;
+
+	if (!plug || in_interrupt())
+		return NULL;
+
+	list_for_each_entry(cb, &plug->cb_list, list) {
+		if (cb->callback == cas_queue_unplug && cb->data == q)
+			return container_of(cb, struct cas_queue_plug_cb, cb);
+	}
+
+	return NULL;
+}
+
 void cas_kick_queue_thread(ocf_queue_t q)
 {
 	struct cas_thread_info *info = ocf_queue_get_priv(q);
+	struct cas_queue_plug_cb *plug_cb = cas_queue_plugged(q);
+
+	if (plug_cb) {
+		plug_cb->kicked = true;
+		return;
+	}
+
 	wake_up(&info->wq);
 }
 
+void cas_queue_batch_io(ocf_queue_t q)
+{
+	struct cas_thread_info *info = ocf_queue_get_priv(q);
+	struct blk_plug_cb *cb;
+
+	cb = blk_check_plugged(cas_queue_unplug, q,
+			sizeof(struct cas_queue_plug_cb));
+	if (!cb) {
+		atomic64_inc(&info->batches);
+		atomic64_inc(&info->batched_ios);
+		return;
+	}
+
+	container_of(cb, struct cas_queue_plug_cb, cb)->ios++;
+}
+
+void cas_queue_get_batch_stats(ocf_queue_t q, uint64_t *batches,
+		uint64_t *ios)
+{
+	struct cas_thread_info *info = ocf_queue_get_priv(q);
+
+	*batches += atomic64_read(&info->batches);
+	*ios += atomic64_read(&info->batched_ios);
+}
+
 
 void cas_stop_queue_thread(ocf_queue_t q)
 {
@@ -242,3 +382,28 @@ void cas_stop_cleaner_thread(ocf_cleaner_t c)
 	ocf_cleaner_set_priv(c, NULL);
 }
 
+int cas_create_netcas_thread(ocf_cache_t cache)
+{
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+	struct cas_thread_info *info;
+	int result;
+
+	result = _cas_create_thread(&info, _cas_netcas_thread, cache,
+			CAS_CPUS_ALL, "cas_netcas_%s",
+			ocf_cache_get_name(cache) + 5);
+	if (!result) {
+		cache_priv->netcas_thread = info;
+		_cas_start_thread(info);
+	}
+
+	return result;
+}
+
+void cas_stop_netcas_thread(ocf_cache_t cache)
+{
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
+
+	_cas_stop_thread(cache_priv->netcas_thread);
+	cache_priv->netcas_thread = NULL;
+}
+
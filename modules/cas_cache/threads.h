@@ -16,8 +16,18 @@ int cas_create_queue_thread(ocf_queue_t q, int cpu);
 void cas_kick_queue_thread(ocf_queue_t q);
 void cas_stop_queue_thread(ocf_queue_t q);
 
+/* Account IO about to be submitted to the queue to the batch of the plug
+ * of the current task, kicks by the task wake the thread once, at the end */
+void cas_queue_batch_io(ocf_queue_t q);
+/* Add batches and IOs submitted in them to given counters */
+void cas_queue_get_batch_stats(ocf_queue_t q, uint64_t *batches,
+		uint64_t *ios);
+
 int cas_create_cleaner_thread(ocf_cleaner_t c);
 void cas_kick_cleaner_thread(ocf_cleaner_t c);
 void cas_stop_cleaner_thread(ocf_cleaner_t c);
 
+int cas_create_netcas_thread(ocf_cache_t cache);
+void cas_stop_netcas_thread(ocf_cache_t cache);
+
 #endif /* __THREADS_H__ */
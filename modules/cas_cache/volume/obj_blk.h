@@ -10,6 +10,8 @@
 #include "vol_block_dev_top.h"
 
 struct casdsk_disk;
+struct cas_backend_throttle;
+struct blkdev_defer_queue;
 
 struct bd_object {
 	struct casdsk_disk *dsk;
@@ -34,8 +36,23 @@ struct bd_object {
 	struct workqueue_struct *expobj_wq;
 		/*< Workqueue for I/O handled by top vol */
 
+	struct blkdev_defer_queue __percpu *expobj_defer;
+		/*< Per-CPU bios deferred to expobj_wq */
+
+	uint32_t max_io_sectors;
+		/*< Max size of single OCF IO split from exported object bio */
+
+	uint32_t io_align_sectors;
+		/*< Boundary exported object bios are split at */
+
+	uint32_t io_split_size;
+		/*< User override of split size in bytes, 0 - device derived */
+
 	ocf_volume_t front_volume;
 		/*< Cache/core front volume */
+
+	struct cas_backend_throttle *throttle;
+		/*< Admission throttle of the cache, core volumes only */
 };
 
 static inline struct bd_object *bd_object(ocf_volume_t vol)
@@ -19,6 +19,10 @@ struct blkio {
 
 	/* BIO vector iterator for sending IO */
 	struct bio_vec_iter iter;
+
+	/* Held back by backend throttle */
+	struct list_head throttle_list;
+	struct ocf_io *throttle_io;
 };
 
 static inline struct blkio *cas_io_to_blkio(struct ocf_io *io)
@@ -6,6 +6,7 @@
 #include <linux/blkdev.h>
 
 #include "cas_cache.h"
+#include "src/ocf/engine/netCAS_splitter.h"
 
 #define CAS_DEBUG_IO 0
 
@@ -353,10 +354,257 @@ static inline bool cas_bd_io_prepare(int *dir, struct ocf_io *io)
 	return true;
 }
 
+/*
+ * Backend admission throttle. While netCAS finds the backend link congested
+ * it publishes a budget, and all IO to the cores of the cache is held to it
+ * by a token bucket shared by the core volumes. IO over the budget waits in
+ * per class lists drained by a delayed work as tokens come in. Foreground IO
+ * may take the bucket down to empty, background IO only down to its reserve
+ * and after all foreground IO waiting, so it yields first.
+ */
+#define CAS_THROTTLE_BURST_NS	(10 * NSEC_PER_MSEC)
+
+enum cas_throttle_class {
+	cas_throttle_foreground,
+	cas_throttle_background,
+	cas_throttle_class_max,
+};
+
+struct cas_backend_throttle {
+	ocf_cache_t cache;
+	struct netcas_splitter *netcas;
+	struct workqueue_struct *wq;
+	struct delayed_work drain;
+
+	spinlock_t lock;
+	int64_t tokens;
+		/*!< Bytes, may go negative after IO larger than the bucket */
+	uint64_t last_ns;
+	struct list_head deferred[cas_throttle_class_max];
+	uint32_t deferred_no;
+	bool drain_pending;
+
+	atomic64_t deferred_total;
+};
+
+static void block_dev_submit_admitted(struct ocf_io *io);
+
+/*
+ * Core writes OCF issues on its own are the cleaner flushing dirty data,
+ * nothing waits for them. Writes of user IO, e.g. pass-through or
+ * sequential cutoff ones, carry the user flag and stay in the foreground.
+ */
+static enum cas_throttle_class cas_throttle_classify(struct ocf_io *io)
+{
+	if (io->dir == OCF_WRITE && !(io->flags & CAS_IO_FLAG_USER))
+		return cas_throttle_background;
+
+	return cas_throttle_foreground;
+}
+
+static int64_t cas_throttle_depth(uint64_t rate)
+{
+	return rate * CAS_THROTTLE_BURST_NS / NSEC_PER_SEC;
+}
+
+static void cas_throttle_refill(struct cas_backend_throttle *throttle,
+		uint64_t rate)
+{
+	uint64_t now = CAS_KTIME_GET_NS();
+	uint64_t elapsed = min_t(uint64_t, now - throttle->last_ns,
+			CAS_THROTTLE_BURST_NS);
+
+	throttle->last_ns = now;
+	throttle->tokens = min_t(int64_t, throttle->tokens +
+			(int64_t)(rate * elapsed / NSEC_PER_SEC),
+			cas_throttle_depth(rate));
+}
+
+/* Tokens the bucket must hold to admit IO of the class */
+static int64_t cas_throttle_need(struct cas_backend_throttle *throttle,
+		enum cas_throttle_class class, uint64_t rate)
+{
+	if (class == cas_throttle_foreground)
+		return 1;
+
+	return cas_throttle_depth(rate) / 2;
+}
+
+static void cas_throttle_schedule(struct cas_backend_throttle *throttle,
+		int64_t need, uint64_t rate)
+{
+	unsigned long delay = 0;
+	uint64_t delay_ns;
+
+	if (rate && throttle->tokens < need) {
+		delay_ns = (need - throttle->tokens) * NSEC_PER_SEC / rate;
+		/* Round up, a sub-jiffy deficit must not requeue at once */
+		delay = max(1UL, (unsigned long)DIV_ROUND_UP_ULL(delay_ns,
+				TICK_NSEC));
+	}
+
+	throttle->drain_pending = true;
+	queue_delayed_work(throttle->wq, &throttle->drain, delay);
+}
+
+static void cas_throttle_drain(struct work_struct *work)
+{
+	struct cas_backend_throttle *throttle = container_of(
+			to_delayed_work(work), struct cas_backend_throttle,
+			drain);
+	uint64_t rate = netcas_get_backend_budget(throttle->netcas);
+	enum cas_throttle_class class;
+	struct blkio *bdio, *tmp;
+	struct blk_plug plug;
+	unsigned long flags;
+	int64_t need = 0;
+	LIST_HEAD(admitted);
+
+	spin_lock_irqsave(&throttle->lock, flags);
+
+	cas_throttle_refill(throttle, rate);
+
+	for (class = 0; class < cas_throttle_class_max; class++) {
+		need = cas_throttle_need(throttle, class, rate);
+		while (!list_empty(&throttle->deferred[class])) {
+			if (rate && throttle->tokens < need)
+				goto out;
+
+			bdio = list_first_entry(&throttle->deferred[class],
+					struct blkio, throttle_list);
+			list_move_tail(&bdio->throttle_list, &admitted);
+			throttle->tokens -= bdio->throttle_io->bytes;
+			WRITE_ONCE(throttle->deferred_no,
+					throttle->deferred_no - 1);
+		}
+	}
+
+out:
+	if (throttle->deferred_no)
+		cas_throttle_schedule(throttle, need, rate);
+	else
+		throttle->drain_pending = false;
+
+	spin_unlock_irqrestore(&throttle->lock, flags);
+
+	blk_start_plug(&plug);
+	list_for_each_entry_safe(bdio, tmp, &admitted, throttle_list) {
+		list_del(&bdio->throttle_list);
+		block_dev_submit_admitted(bdio->throttle_io);
+	}
+	blk_finish_plug(&plug);
+}
+
+/*
+ * Take tokens for IO, or hold it back when the bucket is short of them
+ * or earlier IO of the same or higher priority is still waiting
+ * @return true if IO was held back and is going to be submitted later
+ */
+static bool cas_throttle_defer(struct cas_backend_throttle *throttle,
+		struct ocf_io *io)
+{
+	struct blkio *bdio = cas_io_to_blkio(io);
+	uint64_t rate = netcas_get_backend_budget(throttle->netcas);
+	enum cas_throttle_class class, ahead;
+	unsigned long flags;
+	int64_t need;
+	bool queued = false;
+
+	if (!rate && !READ_ONCE(throttle->deferred_no))
+		return false;
+
+	class = cas_throttle_classify(io);
+
+	spin_lock_irqsave(&throttle->lock, flags);
+
+	cas_throttle_refill(throttle, rate);
+	need = cas_throttle_need(throttle, class, rate);
+
+	for (ahead = 0; ahead <= class; ahead++)
+		queued |= !list_empty(&throttle->deferred[ahead]);
+
+	if (!queued && (!rate || throttle->tokens >= need)) {
+		throttle->tokens -= io->bytes;
+		spin_unlock_irqrestore(&throttle->lock, flags);
+		return false;
+	}
+
+	bdio->throttle_io = io;
+	list_add_tail(&bdio->throttle_list, &throttle->deferred[class]);
+	WRITE_ONCE(throttle->deferred_no, throttle->deferred_no + 1);
+	atomic64_inc(&throttle->deferred_total);
+	if (!throttle->drain_pending)
+		cas_throttle_schedule(throttle, need, rate);
+
+	spin_unlock_irqrestore(&throttle->lock, flags);
+
+	return true;
+}
+
+int cas_backend_throttle_init(ocf_cache_t cache,
+		struct netcas_splitter *netcas,
+		struct cas_backend_throttle **throttle)
+{
+	struct cas_backend_throttle *tmp;
+	enum cas_throttle_class class;
+
+	tmp = kzalloc(sizeof(*tmp), GFP_KERNEL);
+	if (!tmp)
+		return -ENOMEM;
+
+	tmp->wq = alloc_workqueue("cas_throttle_%s",
+			WQ_MEM_RECLAIM | WQ_HIGHPRI, 0,
+			ocf_cache_get_name(cache));
+	if (!tmp->wq) {
+		kfree(tmp);
+		return -ENOMEM;
+	}
+
+	tmp->netcas = netcas;
+	INIT_DELAYED_WORK(&tmp->drain, cas_throttle_drain);
+	spin_lock_init(&tmp->lock);
+	for (class = 0; class < cas_throttle_class_max; class++)
+		INIT_LIST_HEAD(&tmp->deferred[class]);
+
+	*throttle = tmp;
+
+	return 0;
+}
+
+/*
+ * Cores are detached by now and nothing is held back anymore, OCF waits
+ * for all IO it submitted before the cache stops
+ */
+void cas_backend_throttle_deinit(struct cas_backend_throttle *throttle)
+{
+	cancel_delayed_work_sync(&throttle->drain);
+	WARN_ON(throttle->deferred_no);
+	destroy_workqueue(throttle->wq);
+	kfree(throttle);
+}
+
+uint64_t cas_backend_throttle_get_deferred(
+		struct cas_backend_throttle *throttle)
+{
+	return atomic64_read(&throttle->deferred_total);
+}
+
 /*
  *
  */
 static void block_dev_submit_io(struct ocf_io *io)
+{
+	struct bd_object *bdobj = bd_object(ocf_io_get_volume(io));
+
+	if (bdobj->throttle && !CAS_IS_SET_FLUSH(io->flags) &&
+			cas_throttle_defer(bdobj->throttle, io)) {
+		return;
+	}
+
+	block_dev_submit_admitted(io);
+}
+
+static void block_dev_submit_admitted(struct ocf_io *io)
 {
 	struct blkio *bdio = cas_io_to_blkio(io);
 	struct bd_object *bdobj = bd_object(ocf_io_get_volume(io));
@@ -403,7 +651,7 @@ static void block_dev_submit_io(struct ocf_io *io)
 		CAS_BIO_BISECTOR(bio) = addr / SECTOR_SIZE;
 		bio->bi_next = NULL;
 		bio->bi_private = io;
-		CAS_BIO_OP_FLAGS(bio) |= io->flags;
+		CAS_BIO_OP_FLAGS(bio) |= io->flags & ~CAS_IO_FLAG_USER;
 		bio->bi_end_io = CAS_REFER_BLOCK_CALLBACK(cas_bd_io_end);
 
 		/* Add pages */
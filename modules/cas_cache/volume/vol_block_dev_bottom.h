@@ -8,6 +8,13 @@
 
 #include "../cas_cache.h"
 
+/*
+ * Adapter private OCF IO flag, above all bio op flags. Set on IO of
+ * exported object bios; OCF passes flags of user IO on to the core, so
+ * core IO without it was issued by OCF itself, i.e. the cleaner.
+ */
+#define CAS_IO_FLAG_USER	(1ULL << 63)
+
 int block_dev_open_object(ocf_volume_t vol, void *volume_params);
 
 void block_dev_close_object(ocf_volume_t vol);
@@ -18,4 +25,13 @@ int block_dev_try_get_io_class(struct bio *bio, int *io_class);
 
 int block_dev_init(void);
 
+int cas_backend_throttle_init(ocf_cache_t cache,
+		struct netcas_splitter *netcas,
+		struct cas_backend_throttle **throttle);
+
+void cas_backend_throttle_deinit(struct cas_backend_throttle *throttle);
+
+uint64_t cas_backend_throttle_get_deferred(
+		struct cas_backend_throttle *throttle);
+
 #endif /* __VOL_BLOCK_DEV_BOTTOM_H__ */
@@ -4,6 +4,8 @@
 */
 
 #include "cas_cache.h"
+#include "threads.h"
+#include "queue_map.h"
 #include "utils/cas_err.h"
 
 static void blkdev_set_bio_data(struct blk_data *data, struct bio *bio)
@@ -92,6 +94,89 @@ static void blkdev_set_discard_properties(ocf_cache_t cache,
 	}
 }
 
+/**
+ * Upper bound of a single OCF IO carved out of an exported object bio and
+ * the default boundary splits are aligned to.
+ */
+#define BLKDEV_MAX_IO_SECTORS ((32*MiB) >> SECTOR_SHIFT)
+#define BLKDEV_IO_ALIGN_SECTORS ((128*KiB) >> SECTOR_SHIFT)
+
+/**
+ * Derive split size and alignment for bios of core exported object from
+ * limits of both bottom devices. Alignment is raised to optimal IO size of
+ * either device, provided it is a multiple of cache line size, so that
+ * split IOs neither straddle device stripes nor partially cover cache lines.
+ * Split size is capped at max_hw_sectors of both devices (unless overriden
+ * by user) so that bottom volumes do not have to split it once again.
+ */
+static void blkdev_core_set_io_split(ocf_core_t core,
+		struct request_queue *core_q, struct request_queue *cache_q)
+{
+	ocf_cache_t cache = ocf_core_get_cache(core);
+	struct bd_object *bvol = bd_object(ocf_core_get_volume(core));
+	uint32_t line_sectors = ocf_cache_get_line_size(cache) >> SECTOR_SHIFT;
+	uint32_t align_sectors = BLKDEV_IO_ALIGN_SECTORS;
+	uint32_t max_sectors = BLKDEV_MAX_IO_SECTORS;
+	uint32_t io_opt;
+
+	io_opt = max(queue_io_opt(core_q), queue_io_opt(cache_q)) >>
+			SECTOR_SHIFT;
+	if (io_opt > align_sectors && io_opt <= max_sectors &&
+			io_opt % line_sectors == 0) {
+		align_sectors = io_opt;
+	}
+
+	if (bvol->io_split_size) {
+		max_sectors = min_t(uint32_t, max_sectors,
+				bvol->io_split_size >> SECTOR_SHIFT);
+	} else {
+		max_sectors = min3(max_sectors, queue_max_hw_sectors(core_q),
+				queue_max_hw_sectors(cache_q));
+	}
+
+	if (max_sectors < align_sectors) {
+		align_sectors = max_t(uint32_t,
+				rounddown_pow_of_two(max_sectors), line_sectors);
+	}
+	max_sectors = max(rounddown(max_sectors, align_sectors), align_sectors);
+
+	WRITE_ONCE(bvol->io_align_sectors, align_sectors);
+	WRITE_ONCE(bvol->max_io_sectors, max_sectors);
+}
+
+int kcas_core_set_io_split_size(ocf_core_t core, uint32_t size)
+{
+	ocf_cache_t cache = ocf_core_get_cache(core);
+	struct bd_object *bvol = bd_object(ocf_core_get_volume(core));
+	struct bd_object *bd_cache_vol = bd_object(ocf_cache_get_volume(cache));
+	struct request_queue *core_q, *cache_q;
+
+	if (size && (size < 4*KiB || size > 32*MiB || size % (4*KiB)))
+		return -OCF_ERR_INVAL;
+
+	bvol->io_split_size = size;
+
+	if (!bvol->expobj_valid)
+		return 0;
+
+	core_q = casdisk_functions.casdsk_disk_get_queue(bvol->dsk);
+	cache_q = casdisk_functions.casdsk_disk_get_queue(bd_cache_vol->dsk);
+
+	blkdev_core_set_io_split(core, core_q, cache_q);
+
+	return 0;
+}
+
+uint32_t kcas_core_get_io_split_size(ocf_core_t core)
+{
+	struct bd_object *bvol = bd_object(ocf_core_get_volume(core));
+
+	if (!bvol->expobj_valid)
+		return bvol->io_split_size;
+
+	return READ_ONCE(bvol->max_io_sectors) << SECTOR_SHIFT;
+}
+
 /**
  * Map geometry of underlying (core) object geometry (sectors etc.)
  * to geometry of exported object.
@@ -152,44 +237,120 @@ static int blkdev_core_set_geometry(struct casdsk_disk *dsk, void *private)
 	blkdev_set_discard_properties(cache, exp_q, cache_bd, core_bd,
 			sectors);
 
+	blkdev_core_set_io_split(core, core_q, cache_q);
+
 	return 0;
 }
 
-struct defer_bio_context {
-	struct work_struct io_work;
-	void (*cb)(struct bd_object *bvol, struct bio *bio);
+static void blkdev_handle_bio(struct bd_object *bvol, struct bio *bio);
+static void blkdev_handle_bio_noflush(struct bd_object *bvol, struct bio *bio);
+
+/*
+ * Bios which arrive in interrupt context are handled by a worker. Each CPU
+ * collects them on lock-free lists of its own and queues the worker only
+ * when a list becomes non-empty, the worker then handles the whole batch.
+ */
+enum blkdev_defer_type {
+	blkdev_defer_handle,
+		/*!< Not yet flushed, blkdev_handle_bio() */
+
+	blkdev_defer_handle_noflush,
+		/*!< Flush completed, blkdev_handle_bio_noflush() */
+
+	blkdev_defer_max,
+};
+
+struct blkdev_defer_queue {
+	struct llist_head bios[blkdev_defer_max];
+	struct work_struct work;
 	struct bd_object *bvol;
-	struct bio *bio;
 };
 
-static void blkdev_defer_bio_work(struct work_struct *work)
+/*
+ * Deferred bio is owned by the exported object until it's handled, so its
+ * bi_next serves as the list node and deferring needs no allocation.
+ */
+static inline struct llist_node *blkdev_bio_llnode(struct bio *bio)
+{
+	BUILD_BUG_ON(sizeof(bio->bi_next) != sizeof(struct llist_node));
+
+	return (struct llist_node *)&bio->bi_next;
+}
+
+static void blkdev_defer_handle_list(struct bd_object *bvol,
+		struct llist_node *llnode, enum blkdev_defer_type type)
 {
-	struct defer_bio_context *context;
+	struct bio *bio;
+
+	/* Lists are LIFO, handle bios in order of arrival */
+	llnode = llist_reverse_order(llnode);
+
+	while (llnode) {
+		bio = container_of((struct bio **)llnode, struct bio, bi_next);
+		llnode = llnode->next;
+		bio->bi_next = NULL;
 
-	context = container_of(work, struct defer_bio_context, io_work);
-	context->cb(context->bvol, context->bio);
-	kfree(context);
+		if (type == blkdev_defer_handle)
+			blkdev_handle_bio(bvol, bio);
+		else
+			blkdev_handle_bio_noflush(bvol, bio);
+	}
+}
+
+static void blkdev_defer_work(struct work_struct *work)
+{
+	struct blkdev_defer_queue *queue = container_of(work,
+			struct blkdev_defer_queue, work);
+	struct blk_plug plug;
+	int type;
+
+	/* Whole batch is submitted to the OCF queue with a single kick */
+	blk_start_plug(&plug);
+	for (type = 0; type < blkdev_defer_max; type++) {
+		blkdev_defer_handle_list(queue->bvol,
+				llist_del_all(&queue->bios[type]), type);
+	}
+	blk_finish_plug(&plug);
 }
 
 static void blkdev_defer_bio(struct bd_object *bvol, struct bio *bio,
-		void (*cb)(struct bd_object *bvol, struct bio *bio))
+		enum blkdev_defer_type type)
 {
-	struct defer_bio_context *context;
+	struct blkdev_defer_queue *queue;
 
 	BUG_ON(!bvol->expobj_wq);
 
-	context = kmalloc(sizeof(*context), GFP_ATOMIC);
-	if (!context) {
-		CAS_BIO_ENDIO(bio, CAS_BIO_BISIZE(bio),
-			CAS_ERRNO_TO_BLK_STS(-ENOMEM));
-		return;
+	/* Called in interrupt context, this CPU's queue can't change */
+	queue = this_cpu_ptr(bvol->expobj_defer);
+	if (llist_add(blkdev_bio_llnode(bio), &queue->bios[type]))
+		queue_work(bvol->expobj_wq, &queue->work);
+}
+
+static int blkdev_defer_init(struct bd_object *bvol)
+{
+	struct blkdev_defer_queue *queue;
+	int cpu, type;
+
+	bvol->expobj_defer = alloc_percpu(struct blkdev_defer_queue);
+	if (!bvol->expobj_defer)
+		return -ENOMEM;
+
+	for_each_possible_cpu(cpu) {
+		queue = per_cpu_ptr(bvol->expobj_defer, cpu);
+		for (type = 0; type < blkdev_defer_max; type++)
+			init_llist_head(&queue->bios[type]);
+		INIT_WORK(&queue->work, blkdev_defer_work);
+		queue->bvol = bvol;
 	}
 
-	context->cb = cb;
-	context->bio = bio;
-	context->bvol = bvol;
-	INIT_WORK(&context->io_work, blkdev_defer_bio_work);
-	queue_work(bvol->expobj_wq, &context->io_work);
+	return 0;
+}
+
+/* Workqueue has to be destroyed first, it handles all deferred bios */
+static void blkdev_defer_deinit(struct bd_object *bvol)
+{
+	free_percpu(bvol->expobj_defer);
+	bvol->expobj_defer = NULL;
 }
 
 static void blkdev_complete_data_master(struct blk_data *master, int error)
@@ -236,8 +397,7 @@ static int blkdev_handle_data_single(struct bd_object *bvol, struct bio *bio,
 		struct blkdev_data_master_ctx *master_ctx)
 {
 	ocf_cache_t cache = ocf_volume_get_cache(bvol->front_volume);
-	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
-	ocf_queue_t queue = cache_priv->io_queues[smp_processor_id()];
+	ocf_queue_t queue = cas_queue_map_select(cache);
 	struct ocf_io *io;
 	struct blk_data *data;
 	uint64_t flags = CAS_BIO_OP_FLAGS(bio);
@@ -255,7 +415,8 @@ static int blkdev_handle_data_single(struct bd_object *bvol, struct bio *bio,
 			CAS_BIO_BISECTOR(bio) << SECTOR_SHIFT,
 			CAS_BIO_BISIZE(bio), (bio_data_dir(bio) == READ) ?
 					OCF_READ : OCF_WRITE,
-			cas_cls_classify(cache, bio), CAS_CLEAR_FLUSH(flags));
+			cas_cls_classify(cache, bio),
+			CAS_CLEAR_FLUSH(flags) | CAS_IO_FLAG_USER);
 
 	if (!io) {
 		printk(KERN_CRIT "Out of memory. Ending IO processing.\n");
@@ -282,6 +443,7 @@ static int blkdev_handle_data_single(struct bd_object *bvol, struct bio *bio,
 
 	ocf_io_set_cmpl(io, bio, master_ctx->data, blkdev_complete_data);
 
+	cas_queue_batch_io(queue);
 	ocf_volume_submit_io(io);
 
 	return 0;
@@ -289,8 +451,8 @@ static int blkdev_handle_data_single(struct bd_object *bvol, struct bio *bio,
 
 static void blkdev_handle_data(struct bd_object *bvol, struct bio *bio)
 {
-	const uint32_t max_io_sectors = (32*MiB) >> SECTOR_SHIFT;
-	const uint32_t align_sectors = (128*KiB) >> SECTOR_SHIFT;
+	const uint32_t max_io_sectors = READ_ONCE(bvol->max_io_sectors);
+	const uint32_t align_sectors = READ_ONCE(bvol->io_align_sectors);
 	struct bio *split = NULL;
 	uint32_t sectors, to_submit;
 	int error;
@@ -350,8 +512,7 @@ static void blkdev_complete_discard(struct ocf_io *io, int error)
 static void blkdev_handle_discard(struct bd_object *bvol, struct bio *bio)
 {
 	ocf_cache_t cache = ocf_volume_get_cache(bvol->front_volume);
-	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
-	ocf_queue_t queue = cache_priv->io_queues[smp_processor_id()];
+	ocf_queue_t queue = cas_queue_map_select(cache);
 	struct ocf_io *io;
 
 	io = ocf_volume_new_io(bvol->front_volume, queue,
@@ -392,7 +553,7 @@ static void blkdev_complete_flush(struct ocf_io *io, int error)
 	}
 
 	if (in_interrupt())
-		blkdev_defer_bio(bvol, bio, blkdev_handle_bio_noflush);
+		blkdev_defer_bio(bvol, bio, blkdev_defer_handle_noflush);
 	else
 		blkdev_handle_bio_noflush(bvol, bio);
 }
@@ -400,8 +561,7 @@ static void blkdev_complete_flush(struct ocf_io *io, int error)
 static void blkdev_handle_flush(struct bd_object *bvol, struct bio *bio)
 {
 	ocf_cache_t cache = ocf_volume_get_cache(bvol->front_volume);
-	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
-	ocf_queue_t queue = cache_priv->io_queues[smp_processor_id()];
+	ocf_queue_t queue = cas_queue_map_select(cache);
 	struct ocf_io *io;
 
 	io = ocf_volume_new_io(bvol->front_volume, queue, 0, 0, OCF_WRITE, 0,
@@ -435,7 +595,7 @@ static void blkdev_submit_bio(struct bd_object *bvol, struct bio *bio)
 	}
 
 	if (in_interrupt())
-		blkdev_defer_bio(bvol, bio, blkdev_handle_bio);
+		blkdev_defer_bio(bvol, bio, blkdev_defer_handle);
 	else
 		blkdev_handle_bio(bvol, bio);
 }
@@ -551,10 +711,20 @@ static int kcas_volume_create_exported_object(ocf_volume_t volume,
 		goto end;
 	}
 
+	result = blkdev_defer_init(bvol);
+	if (result) {
+		destroy_workqueue(bvol->expobj_wq);
+		goto end;
+	}
+
+	bvol->max_io_sectors = BLKDEV_MAX_IO_SECTORS;
+	bvol->io_align_sectors = BLKDEV_IO_ALIGN_SECTORS;
+
 	result = casdisk_functions.casdsk_exp_obj_create(dsk, name,
 			THIS_MODULE, ops);
 	if (result) {
 		destroy_workqueue(bvol->expobj_wq);
+		blkdev_defer_deinit(bvol);
 		goto end;
 	}
 
@@ -593,6 +763,7 @@ static int kcas_volume_destroy_exported_object(ocf_volume_t volume)
 
 	bvol->expobj_valid = false;
 	destroy_workqueue(bvol->expobj_wq);
+	blkdev_defer_deinit(bvol);
 
 out:
 	casdisk_functions.casdsk_exp_obj_unlock(bvol->dsk);
@@ -619,6 +790,7 @@ static int kcas_volume_activate_exported_object(ocf_volume_t volume,
 int kcas_core_create_exported_object(ocf_core_t core)
 {
 	ocf_cache_t cache = ocf_core_get_cache(core);
+	struct cache_priv *cache_priv = ocf_cache_get_priv(cache);
 	ocf_volume_t volume = ocf_core_get_volume(core);
 	struct bd_object *bvol = bd_object(volume);
 	char dev_name[DISK_NAME_LEN];
@@ -628,6 +800,7 @@ int kcas_core_create_exported_object(ocf_core_t core)
 			get_core_id_string(core));
 
 	bvol->front_volume = ocf_core_get_front_volume(core);
+	bvol->throttle = cache_priv->backend_throttle;
 
 	return kcas_volume_create_exported_object(volume, dev_name, core,
 			&kcas_core_exp_obj_ops);
@@ -637,6 +810,8 @@ int kcas_core_destroy_exported_object(ocf_core_t core)
 {
 	ocf_volume_t volume = ocf_core_get_volume(core);
 
+	bd_object(volume)->throttle = NULL;
+
 	return kcas_volume_destroy_exported_object(volume);
 }
 
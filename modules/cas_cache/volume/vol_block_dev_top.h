@@ -11,6 +11,9 @@ int kcas_core_create_exported_object(ocf_core_t core);
 int kcas_core_destroy_exported_object(ocf_core_t core);
 int kcas_core_activate_exported_object(ocf_core_t core);
 
+int kcas_core_set_io_split_size(ocf_core_t core, uint32_t size);
+uint32_t kcas_core_get_io_split_size(ocf_core_t core);
+
 int kcas_cache_destroy_all_core_exported_objects(ocf_cache_t cache);
 
 int kcas_cache_create_exported_object(ocf_cache_t cache);
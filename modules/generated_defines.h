@@ -208,6 +208,7 @@ static inline struct bio *cas_bio_clone(struct bio *bio, gfp_t gfp_mask)
 		return submit_bio(bio);
 	}
 #define CAS_GET_CURRENT_TIME(timespec) ktime_get_real_ts64(timespec)
+#define CAS_KTIME_GET_NS() ktime_get_ns()
 
         static inline int cas_vfs_ioctl(struct file *file, unsigned int cmd,
                 unsigned long arg)
@@ -152,6 +152,28 @@ struct kcas_flush_core {
 	int ext_err_code;
 };
 
+/** netCAS modes, in order of kcas_netcas.mode values */
+#define KCAS_NETCAS_MODES 5
+
+/**
+ * netCAS statistics of a core or of all cores of a cache
+ */
+struct kcas_netcas_stats {
+	/** false if the cache runs without netCAS splitter */
+	bool enabled;
+
+	uint64_t cache_hits; /**< clean hits served by cache */
+	uint64_t backend_hits; /**< clean hits offloaded to backend */
+	uint64_t dirty_hits; /**< never offloaded */
+	uint64_t cache_hit_bytes;
+	uint64_t backend_hit_bytes;
+	uint64_t cache_bytes; /**< reads served by cache */
+	uint64_t backend_bytes; /**< reads served by backend */
+	uint64_t achieved_ratio; /**< 0-10000, clean hits only */
+	uint64_t target_ratio; /**< 0-10000 */
+	uint64_t mode_time_us[KCAS_NETCAS_MODES]; /**< time of the cache in each mode */
+};
+
 struct kcas_get_stats {
 	/** id of a cache */
 	uint16_t cache_id;
@@ -171,6 +193,8 @@ struct kcas_get_stats {
 
 	struct ocf_stats_errors errors;
 
+	struct kcas_netcas_stats netcas;
+
 	int ext_err_code;
 };
 
@@ -237,6 +261,15 @@ struct kcas_core_pool_count {
 /**
  * IO class info and statistics
  */
+/**
+ * netCAS split ratio bounds of an IO class - share of hits served by
+ * cache in 0-10000 scale
+ */
+struct kcas_netcas_io_class {
+	uint16_t min_split;
+	uint16_t max_split;
+};
+
 struct kcas_io_class {
 	/** Cache ID */
 	uint16_t cache_id;
@@ -247,9 +280,13 @@ struct kcas_io_class {
 	/** IO class info */
 	struct ocf_io_class_info info;
 
+	/** netCAS split ratio bounds, full range without netCAS splitter */
+	struct kcas_netcas_io_class netcas;
+
 	int ext_err_code;
 };
 
+
 /**
  * IO class settings
  */
@@ -259,6 +296,9 @@ struct kcas_io_classes {
 
 	int ext_err_code;
 
+	/** netCAS split ratio bounds of each IO class */
+	struct kcas_netcas_io_class netcas[OCF_USER_IO_CLASS_MAX];
+
 	/** IO class info */
 	struct ocf_io_class_info info[];
 };
@@ -304,6 +344,7 @@ enum kcas_core_param_id {
 	core_param_seq_cutoff_threshold,
 	core_param_seq_cutoff_policy,
 	core_param_seq_cutoff_promotion_count,
+	core_param_io_split_max_size,
 	core_param_id_max,
 };
 
@@ -336,9 +377,26 @@ enum kcas_cache_param_id {
 	cache_param_promotion_policy_type,
 	cache_param_promotion_nhit_insertion_threshold,
 	cache_param_promotion_nhit_trigger_threshold,
+	cache_param_io_queue_policy,
 	cache_param_id_max,
 };
 
+/**
+ * Policy of mapping submitting CPU to OCF IO queue of a cache
+ */
+enum kcas_io_queue_policy {
+	/** Queue of submitting CPU */
+	io_queue_policy_per_cpu,
+
+	/** Queues of NUMA node of submitting CPU, round-robin */
+	io_queue_policy_numa_node,
+
+	/** Queues of NUMA node cache device is attached to, round-robin */
+	io_queue_policy_device_local,
+
+	io_queue_policy_max,
+};
+
 struct kcas_set_cache_param {
 	uint16_t cache_id;
 	enum kcas_cache_param_id param_id;
@@ -370,6 +428,82 @@ struct kcas_standby_activate
 	int ext_err_code;
 };
 
+/** netCAS split ratios are in 0-10000 range */
+#define KCAS_NETCAS_RATIO_UNPINNED ((uint32_t)-1)
+
+/** Values to be applied by KCAS_IOCTL_NETCAS */
+#define KCAS_NETCAS_SET_INTERVAL	(1 << 0)
+#define KCAS_NETCAS_SET_LOG_INTERVAL	(1 << 1)
+#define KCAS_NETCAS_SET_THRESHOLDS	(1 << 2)
+#define KCAS_NETCAS_SET_PIN		(1 << 3)
+#define KCAS_NETCAS_SET_UNPIN		(1 << 4)
+#define KCAS_NETCAS_SET_RESET		(1 << 5)
+#define KCAS_NETCAS_SET_POLICY		(1 << 6)
+#define KCAS_NETCAS_SET_P99_TARGET	(1 << 7)
+#define KCAS_NETCAS_SET_HEDGE_BUDGET	(1 << 8)
+#define KCAS_NETCAS_SET_HEDGE_PERCENTILE	(1 << 9)
+
+/** Cache engine hooks which feed netCAS statistics, see engine_hooks */
+#define KCAS_NETCAS_HOOK_COMPLETION	(1 << 0)
+#define KCAS_NETCAS_HOOK_HEDGE		(1 << 1)
+#define KCAS_NETCAS_HOOK_TARGET		(1 << 2)
+
+enum kcas_netcas_size_class {
+	kcas_netcas_size_small,
+	kcas_netcas_size_medium,
+	kcas_netcas_size_large,
+	kcas_netcas_size_max,
+};
+
+struct kcas_netcas {
+	uint16_t cache_id;
+
+	/** KCAS_NETCAS_SET_* mask of values to apply before readout */
+	uint32_t set_flags;
+
+	/* Tunables, applied according to set_flags and read back */
+	uint32_t monitor_interval_ms;
+	uint32_t log_interval_ms; /**< 0 disables periodic log */
+	uint32_t latency_congestion_threshold; /**< permil */
+	uint32_t latency_recovery_threshold; /**< permil */
+	uint32_t pinned_ratio;
+	uint32_t policy; /**< 0 - formula, 1 - hill climbing */
+	uint64_t p99_target_ns; /**< 0 disables tail steering */
+	uint32_t hedge_budget; /**< permil of clean hits, 0 disables hedging */
+	uint32_t hedge_percentile; /**< permil */
+
+	/* Telemetry from the last monitor step */
+	uint32_t mode;
+	uint32_t active_policy;
+	uint64_t optimal_ratio;
+	uint64_t published_ratio[kcas_netcas_size_max];
+	uint64_t achieved_ratio; /**< clean hits only */
+	uint64_t dirty_hit_ratio; /**< dirty hits are never offloaded */
+	uint64_t rdma_throughput;
+	uint64_t max_rdma_throughput;
+	uint64_t rdma_latency;
+	uint64_t min_rdma_latency;
+	uint64_t bw_drop_permil;
+	uint64_t latency_increase_permil;
+	uint64_t cache_throughput;
+	uint64_t backend_throughput;
+	uint64_t cache_p99_ns;
+	uint64_t backend_p99_ns;
+	uint64_t io_depth;
+	uint64_t numjob;
+	int64_t tail_bias;
+	uint64_t cache_hedge_delay_ns;
+	uint64_t backend_hedge_delay_ns;
+	uint64_t hedges;
+	uint64_t hedge_wins;
+	uint64_t backend_budget; /**< bytes/s, 0 - backend not throttled */
+	uint64_t throttled_ios; /**< held back by the backend budget */
+	/** KCAS_NETCAS_HOOK_* called so far, statistics of others stay zero */
+	uint32_t engine_hooks;
+
+	int ext_err_code;
+};
+
 /*******************************************************************************
  *   CODE   *              NAME             *               STATUS             *
  *******************************************************************************
@@ -411,6 +545,7 @@ struct kcas_standby_activate
  *    38    *    KCAS_IOCTL_STANDBY_DETACH                  *    OK            *
  *    39    *    KCAS_IOCTL_STANDBY_ACTIVATE                *    OK            *
  *    40    *    KCAS_IOCTL_CORE_INFO                       *    OK            *
+ *    41    *    KCAS_IOCTL_NETCAS                          *    OK            *
  *******************************************************************************
  */
 
@@ -509,6 +644,9 @@ struct kcas_standby_activate
 /** Rretrieve statisting of a given core object */
 #define KCAS_IOCTL_CORE_INFO _IOWR(KCAS_IOCTL_MAGIC, 40, struct kcas_core_info)
 
+/** Tune netCAS splitter of a cache instance and retrieve its telemetry */
+#define KCAS_IOCTL_NETCAS _IOWR(KCAS_IOCTL_MAGIC, 41, struct kcas_netcas)
+
 /**
  * Extended kernel CAS error codes
  */
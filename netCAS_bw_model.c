@@ -0,0 +1,84 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ocf/ocf.h"
+#include "netCAS_bw_model.h"
+#include "../utils/pmem_nvme/pmem_nvme_table.h"
+
+/* NetCAS bandwidth model - online replacement for the static table */
+
+// Weight of the previous value in the moving average, out of 4
+#define BW_MODEL_EWMA_OLD_WEIGHT 3
+
+/**
+ * @brief Map value to its power of two bucket, clamped to bucket count
+ */
+static uint32_t bw_model_bucket(uint64_t value, uint32_t buckets)
+{
+    uint32_t bucket = 0;
+
+    while (value > 1 && bucket < buckets - 1)
+    {
+        value >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+/**
+ * @brief Drop all measured samples
+ */
+void netcas_bw_model_init(struct netcas_bw_model *model)
+{
+    env_memset(model, sizeof(*model), 0);
+}
+
+/**
+ * @brief Feed measured bandwidth of a path into the model
+ */
+void netcas_bw_model_update(struct netcas_bw_model *model, enum netcas_path path,
+                            enum netcas_size_class size, uint64_t io_depth,
+                            uint64_t numjob, uint64_t bandwidth)
+{
+    uint32_t qd = bw_model_bucket(io_depth, NETCAS_BW_MODEL_QD_BUCKETS);
+    uint32_t jobs = bw_model_bucket(numjob, NETCAS_BW_MODEL_JOB_BUCKETS);
+    uint64_t *entry = &model->bandwidth[path][size][qd][jobs];
+
+    if (bandwidth == 0)
+        return;
+
+    // First sample is taken as is, later ones are smoothed
+    if (*entry == 0)
+        *entry = bandwidth;
+    else
+        *entry = (*entry * BW_MODEL_EWMA_OLD_WEIGHT + bandwidth) / (BW_MODEL_EWMA_OLD_WEIGHT + 1);
+}
+
+/**
+ * @brief Get cache-only and backend-only bandwidth for given key
+ */
+bool netcas_bw_model_lookup(struct netcas_bw_model *model, enum netcas_size_class size,
+                            uint64_t io_depth, uint64_t numjob,
+                            uint64_t *bandwidth_cache_only, uint64_t *bandwidth_backend_only)
+{
+    uint32_t qd = bw_model_bucket(io_depth, NETCAS_BW_MODEL_QD_BUCKETS);
+    uint32_t jobs = bw_model_bucket(numjob, NETCAS_BW_MODEL_JOB_BUCKETS);
+    uint64_t cache_bw = model->bandwidth[NETCAS_PATH_CACHE][size][qd][jobs];
+    uint64_t backend_bw = model->bandwidth[NETCAS_PATH_BACKEND][size][qd][jobs];
+
+    if (cache_bw && backend_bw)
+    {
+        *bandwidth_cache_only = cache_bw;
+        *bandwidth_backend_only = backend_bw;
+        return true;
+    }
+
+    // Not calibrated for this key yet - use the static table for both paths
+    *bandwidth_cache_only = (uint64_t)lookup_bandwidth(io_depth, numjob, 100);
+    *bandwidth_backend_only = (uint64_t)lookup_bandwidth(io_depth, numjob, 0);
+
+    return false;
+}
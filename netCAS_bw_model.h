@@ -0,0 +1,46 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __NETCAS_BW_MODEL_H__
+#define __NETCAS_BW_MODEL_H__
+
+#include "ocf/ocf.h"
+#include "netCAS_splitter.h"
+
+/* Buckets are powers of two: 1, 2, 4, ... */
+#define NETCAS_BW_MODEL_QD_BUCKETS 9   /* Queue depth 1 .. 256 */
+#define NETCAS_BW_MODEL_JOB_BUCKETS 7  /* Submitters 1 .. 64 */
+
+/*
+ * Live bandwidth model. Holds the delivered bandwidth of each path measured
+ * during calibration probes, keyed by request size class, queue depth and
+ * number of submitters. Keys without samples fall back to the static
+ * pmem_nvme table, which doesn't distinguish request sizes.
+ */
+struct netcas_bw_model
+{
+    uint64_t bandwidth[NETCAS_PATH_MAX][NETCAS_SIZE_MAX]
+                      [NETCAS_BW_MODEL_QD_BUCKETS][NETCAS_BW_MODEL_JOB_BUCKETS];
+};
+
+/* Drop all measured samples */
+void netcas_bw_model_init(struct netcas_bw_model *model);
+
+/* Feed measured bandwidth of a path at given size class, queue depth and job count */
+void netcas_bw_model_update(struct netcas_bw_model *model, enum netcas_path path,
+                            enum netcas_size_class size, uint64_t io_depth,
+                            uint64_t numjob, uint64_t bandwidth);
+
+/*
+ * Get cache-only (A) and backend-only (B) bandwidth for given key. Both
+ * values come from the same source - measured if both paths have been
+ * calibrated for this key, static table otherwise.
+ * @return true if measured values were used
+ */
+bool netcas_bw_model_lookup(struct netcas_bw_model *model, enum netcas_size_class size,
+                            uint64_t io_depth, uint64_t numjob,
+                            uint64_t *bandwidth_cache_only, uint64_t *bandwidth_backend_only);
+
+#endif /* __NETCAS_BW_MODEL_H__ */
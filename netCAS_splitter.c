@@ -3,30 +3,29 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+/*
+ * Only env primitives, the request and the helpers below are used, so the
+ * same source also builds in userspace against tools/netcas_sim shims.
+ */
 #include "ocf/ocf.h"
-#include "../ocf_cache_priv.h"
-#include "engine_fast.h"
 #include "engine_common.h"
-#include "engine_pt.h"
-#include "engine_wb.h"
 #include "../ocf_request.h"
-#include "../utils/utils_user_part.h"
-#include "../utils/utils_io.h"
-#include "../concurrency/ocf_concurrency.h"
-#include "../metadata/metadata.h"
 #include "netCAS_splitter.h"
 #include "netCAS_common.h"
 #include "netCAS_monitor.h"
-#include "../utils/pmem_nvme/pmem_nvme_table.h"
+#include "netCAS_bw_model.h"
 #include <linux/kernel.h>
-#include <linux/jiffies.h>
-#include <linux/time.h>
-#include <linux/random.h>
+#include <linux/sched.h>
+#include <linux/hash.h>
+#include <linux/math64.h>
+#include <linux/bitops.h>
 
 /* NetCAS Splitter - Handles cache/backend request distribution */
 
 // Constants
+#ifndef UINT64_MAX
 #define UINT64_MAX 0xFFFFFFFFFFFFFFFFULL
+#endif
 
 // Debug flag for this file - can be set to 0 or 1
 static int netCAS_debug = 0;
@@ -43,7 +42,7 @@ void netcas_set_debug(int debug_level)
 
 // Constants from original netCAS implementation
 #define MONITOR_INTERVAL_MS 100         /* Check every 0.1 second */
-#define LOG_INTERVAL_MS 1000            /* Log every 1 second */
+#define LOG_INTERVAL_MS 0               /* No periodic log until set with casadm */
 #define RDMA_THRESHOLD 100              /* Threshold for starting warmup */
 #define BW_CONGESTION_THRESHOLD 90      /* 9.0% drop threshold for bandwidth congestion */
 #define LATENCY_CONGESTION_THRESHOLD 70 /* 7.0% drop threshold for latency congestion */
@@ -52,663 +51,3093 @@ void netcas_set_debug(int debug_level)
 #define RDMA_LATENCY_THRESHOLD 1000000  /* 1ms in nanoseconds */
 #define IOPS_THRESHOLD 1000             /* 1000 IOPS */
 
-/* Latency baseline management constants */
-#define LATENCY_STABILIZATION_SAMPLES 40 /* Wait 10 samples before setting baseline */
+/* Runtime tunables limits */
+#define MONITOR_INTERVAL_MIN_MS 1
+#define MONITOR_INTERVAL_MAX_MS 10000
+#define LOG_INTERVAL_MAX_MS 3600000
+#define THRESHOLD_MAX 1000
+
+/* Online calibration constants */
+#define CALIBRATION_PERIOD_US 5000000   /* Probe both paths every 5 seconds */
+#define CALIBRATION_PROBE_SAMPLES 2     /* Samples per probe, only the last one is measured */
+
+/* Hill climbing controller constants */
+#define HILL_CLIMB_STEP_MAX 1000        /* 10.0% initial perturbation */
+#define HILL_CLIMB_STEP_MIN 50          /* 0.5% finest perturbation */
+#define HILL_CLIMB_MEASURE_SAMPLES 5    /* Samples averaged into one score */
+#define HILL_CLIMB_SETTLE_SAMPLES 1     /* Samples skipped after every move */
+#define HILL_CLIMB_GUARD_BAND 20        /* 2.0% score change treated as noise */
+
+/* Completion latency histogram constants */
+#define LATENCY_HIST_BUCKETS 32         /* Power of two buckets */
+#define LATENCY_HIST_SHIFT 10           /* First bucket holds latencies below ~1 us */
+#define LATENCY_P99_PERIOD_US 1000000   /* Compute p99 every second */
+#define LATENCY_P99_MIN_COMPLETIONS 100 /* Fewer completions keep the previous p99 */
+#define TAIL_BIAS_STEP 200              /* 2.0% shift per period while a tail is over target */
+#define TAIL_BIAS_MAX 5000              /* Tail steering never moves ratio by more than 50% */
+#define P99_PERMIL 990                  /* Percentile reported and steered as p99 */
+
+// Hedged reads
+#define HEDGE_PERCENTILE 990            /* Duplicate reads slower than p99 of their path */
+#define HEDGE_PERCENTILE_MIN 500
+#define HEDGE_PERCENTILE_MAX 999
+#define HEDGE_BUDGET_MAX 500            /* Never more than one hedge per two clean hits */
+#define HEDGE_COST 1000                 /* Credit of one hedge, clean hits earn budget permil */
+#define HEDGE_CREDIT_MAX (256 * HEDGE_COST) /* Burst of hedges a CPU may save up for */
+
+// Backend read targets
+#define TARGET_SETS_MAX 8               /* Cores with read targets per cache */
+#define TARGET_PROBE_WEIGHT 200         /* 2.0% of backend reads keep probing a congested target */
+#define TARGET_MIN_COMPLETIONS 16       /* Fewer completions keep the previous latency */
+#define TARGET_WARMUP_SAMPLES 10        /* Samples before a target is judged */
+#define TARGET_LATENCY_EWMA_OLD_WEIGHT 3 /* Weight of previous latency in the average, out of 4 */
+#define TARGET_CONGESTION_THRESHOLD 300 /* 30.0% slower than the fastest target of the core */
+#define TARGET_RECOVERY_THRESHOLD 100   /* 10.0% slower than the fastest target of the core */
+#define TARGET_CAPACITY_SCALE 1000      /* Effective over nominal bandwidth, permil */
+
+// Per-core statistics
+#define CORE_STATS_SLOTS 16             /* Cores counted per CPU, later ones share counters */
+#define CORE_STATS_SHARED (CORE_STATS_SLOTS + 1) /* Slot of cores past them */
+
+/* Latency congestion detector constants */
+#define LATENCY_STABILIZATION_SAMPLES 40 /* Samples before the baseline is set */
+#define LATENCY_EWMA_US 500000          /* Mean and variance follow samples over ~500 ms */
+#define LATENCY_RELEARN_US 30000000     /* Baseline follows a higher mean over ~30 s */
+#define LATENCY_HOLD_US 5000000        /* Baseline stays put for 5 s after congestion */
+#define LATENCY_SIGMA_ENTER 3           /* Mean 3 sigma above baseline enters congestion */
+#define LATENCY_SIGMA_EXIT 1            /* Mean within 1 sigma of baseline leaves it */
+#define CONGESTION_ENTER_DWELL_US 300000 /* Over the entry threshold for 300 ms to enter */
+#define CONGESTION_EXIT_DWELL_US 1000000 /* Under the exit threshold for 1 s to leave */
+
+/* Backend admission budget while congested */
+#define BUDGET_DECREASE_PERMIL 900      /* Shrinks by 10% a sample while latency rises */
+#define BUDGET_RISE_PERMIL 50           /* Latency 5% over the last adjustment is rising */
+#define BUDGET_INCREASE_PERMIL 50       /* Grows by 5% of the peak a sample once it is back */
+#define BUDGET_FLOOR_PERMIL 200         /* Never below 20% of the peak link throughput */
+#define BUDGET_BYTES_PER_MIB (1024 * 1024)
 
 /* Scale constants for split ratio (0-10000 where 10000 = 100%) - now in netcas_common.h */
 
-/* Test app parameters */
-static const uint64_t IO_DEPTH = 16;
-static const uint64_t NUM_JOBS = 1;
-static const bool CACHING_FAILED = false;
+/* Request size class bounds */
+#define SIZE_SMALL_MAX_BYTES (16 * 1024)
+#define SIZE_MEDIUM_MAX_BYTES (128 * 1024)
+
+/* IO class bounds packing */
+#define IO_CLASS_BOUNDS(min, max) (((min) << 16) | (max))
+#define IO_CLASS_BOUNDS_MIN(bounds) ((uint32_t)(bounds) >> 16)
+#define IO_CLASS_BOUNDS_MAX(bounds) ((uint32_t)(bounds) & 0xFFFF)
 
-// Static variables for tracking split statistics (simplified for random-based approach)
-static uint32_t request_counter = 0;
-static uint32_t cache_quota = 0;
-static uint32_t backend_quota = 0;
-static bool last_request_to_cache = false;
-static uint32_t pattern_position = 0;
-static uint32_t pattern_cache = 0;
-static uint32_t pattern_backend = 0;
-static uint32_t pattern_size = 0;
-static uint32_t total_requests = 0;
-static uint32_t cache_requests = 0;
-static uint32_t backend_requests = 0;
+/* Workload parallelism tracking constants */
+#define SUBMITTER_HASH_BITS 6         /* Distinct submitters tracked in a 64-bit mask */
+#define PARALLELISM_EWMA_OLD_WEIGHT 3 /* Weight of previous value in the average, out of 4 */
+#define PARALLELISM_DEFAULT_IO_DEPTH 16 /* Keys used until completions are accounted */
+#define PARALLELISM_DEFAULT_NUMJOB 1
+#define PARALLELISM_MAX_IO_DEPTH (1ULL << (NETCAS_BW_MODEL_QD_BUCKETS - 1))
+#define PARALLELISM_MAX_NUMJOB (1ULL << (NETCAS_BW_MODEL_JOB_BUCKETS - 1))
+
+/* Trace record field limits */
+#define TRACE_U32_MAX ((uint32_t)~0U)
+#define TRACE_U16_MAX ((uint16_t)~0U)
+
+static const bool CACHING_FAILED = false;
 
 // Configuration constants
 static const uint32_t WINDOW_SIZE = 100;
-static const uint32_t MAX_PATTERN_SIZE = 10;
 
-// Moving average window for RDMA throughput
-static uint64_t rdma_throughput_window[RDMA_WINDOW_SIZE] = {0};
-static uint64_t rdma_window_index = 0;
-static uint64_t rdma_window_sum = 0;
-static uint64_t rdma_window_count = 0;
-static uint64_t rdma_window_average = 0;
-static uint64_t max_average_rdma_throughput = 0;
+/*
+ * Split pattern of one request size class. It's a Bresenham accumulator at
+ * full 0-10000 ratio resolution: cache_deficit is the cache share of hit
+ * bytes seen minus bytes routed to cache, scaled by SPLIT_RATIO_MAX. Every
+ * hit goes to the path which leaves the deficit closest to zero, so picks
+ * of the minority path are spread evenly and a run to either path is never
+ * longer than the ratio requires. The deficit is carried over windows, only
+ * the ratio snapshot is refreshed.
+ */
+struct netcas_split_pattern
+{
+    uint32_t split_ratio;          // Ratio snapshot taken at window start
+    uint32_t request_counter;
+    int64_t cache_deficit;
+};
 
-// Moving average window for RDMA latency
-static uint64_t rdma_latency_window[RDMA_WINDOW_SIZE] = {0};
-static uint64_t rdma_latency_window_index = 0;
-static uint64_t rdma_latency_window_sum = 0;
-static uint64_t rdma_latency_window_count = 0;
-static uint64_t rdma_latency_window_average = 0;
-static uint64_t min_average_rdma_latency = UINT64_MAX;
+/*
+ * Per-CPU state of the read targets of one core. Targets are picked by
+ * smooth weighted round robin: every read adds its bytes times the weight
+ * to the credit of each target, the target with the highest credit serves
+ * it and pays bytes times the total weight. Like the split pattern it's
+ * deterministic and spreads reads of a target evenly.
+ */
+struct netcas_target_dispatch
+{
+    int64_t credit[NETCAS_TARGET_MAX];
+    env_atomic64 completed_bytes[NETCAS_TARGET_MAX];
+    env_atomic64 completions[NETCAS_TARGET_MAX];
+    env_atomic64 latency_sum[NETCAS_TARGET_MAX]; // ns
+};
 
-// Latency baseline management variables
-static uint64_t latency_sample_count = 0;
-static bool latency_baseline_established = false;
+/*
+ * Statistics of one core for casadm. Each CPU counts the first
+ * CORE_STATS_SLOTS cores of the cache on its own, cores past them are
+ * counted in counters shared by all CPUs.
+ */
+struct netcas_core_counters
+{
+    env_atomic64 hits[NETCAS_PATH_MAX];
+    env_atomic64 hit_bytes[NETCAS_PATH_MAX];
+    env_atomic64 dirty_hits;
+    env_atomic64 dirty_hit_bytes;
+    env_atomic64 completed_bytes[NETCAS_PATH_MAX];
+};
 
-// Mode management variables
-static bool netCAS_initialized = false;
-static bool split_ratio_calculated_in_stable = false; // Track if split ratio was calculated in stable mode
-static netCAS_mode_t current_mode = NETCAS_MODE_IDLE;
+/*
+ * Per-CPU dispatcher. Every submitting CPU runs the split pattern on its own
+ * deficit counters, so the hot path never writes a shared cache line. Each
+ * CPU holds the published ratio within one WINDOW_SIZE window, which bounds
+ * the error of the global achieved ratio. Every IO class keeps its own
+ * patterns, so classes with different bounds don't skew each other.
+ */
+struct netcas_dispatch
+{
+    struct netcas_split_pattern pattern[OCF_USER_IO_CLASS_MAX][NETCAS_SIZE_MAX];
 
-// Optimal split ratio management
-static uint64_t optimal_split_ratio = SPLIT_RATIO_MAX; // Default 100% to cache
-static env_rwlock split_ratio_lock;
+    // Achieved split - hits and hit bytes routed to each path by this CPU
+    env_atomic64 cache_hits;
+    env_atomic64 backend_hits;
+    env_atomic64 hit_bytes[NETCAS_PATH_MAX];
 
-// Global variable to track last logged time (unused for now)
-// static uint64_t last_logged_time = 0;
+    // Hits on dirty cache lines, always served by cache
+    env_atomic64 dirty_hits;
+    env_atomic64 dirty_hit_bytes;
 
-// Timing control for monitor updates
-static uint64_t last_monitor_update_time = 0;
-static uint64_t last_logged_time = 0;
+    // Bytes of completed reads served by each path
+    env_atomic64 completed_bytes[NETCAS_PATH_MAX][NETCAS_SIZE_MAX];
 
-// lookup_bandwidth function is now available from pmem_nvme_table.h
+    // In-flight tracking - submitted and completed requests on this CPU
+    env_atomic64 submitted;
+    env_atomic64 completed;
 
-/**
- * @brief Update RDMA throughput window for moving average calculation
- */
-static void update_rdma_window(uint64_t curr_rdma_throughput)
-{
-    // Update window
-    if (rdma_window_count < RDMA_WINDOW_SIZE)
-    {
-        rdma_window_count++;
-    }
-    else
-    {
-        rdma_window_sum -= rdma_throughput_window[rdma_window_index];
-    }
-    rdma_throughput_window[rdma_window_index] = curr_rdma_throughput;
-    rdma_window_sum += curr_rdma_throughput;
-    rdma_window_average = rdma_window_sum / rdma_window_count;
-    rdma_window_index = (rdma_window_index + 1) % RDMA_WINDOW_SIZE;
+    // Hashed PIDs of tasks which submitted since the last monitor sample
+    uint64_t submitter_mask;
 
-    if (max_average_rdma_throughput < rdma_window_average)
-    {
-        max_average_rdma_throughput = rdma_window_average;
-        NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: max_average_rdma_throughput: %llu", max_average_rdma_throughput);
-    }
-}
+    // Completion latency of each path, power of two buckets
+    env_atomic64 latency_hist[NETCAS_PATH_MAX][LATENCY_HIST_BUCKETS];
 
-/**
- * @brief Update RDMA latency window for moving average calculation
- */
-static void update_rdma_latency_window(uint64_t curr_rdma_latency)
-{
-    // Update window
-    if (rdma_latency_window_count < RDMA_WINDOW_SIZE)
-    {
-        rdma_latency_window_count++;
-    }
-    else
-    {
-        rdma_latency_window_sum -= rdma_latency_window[rdma_latency_window_index];
-    }
-    rdma_latency_window[rdma_latency_window_index] = curr_rdma_latency;
-    rdma_latency_window_sum += curr_rdma_latency;
-    rdma_latency_window_average = rdma_latency_window_sum / rdma_latency_window_count;
-    rdma_latency_window_index = (rdma_latency_window_index + 1) % RDMA_WINDOW_SIZE;
+    // Hedge budget earned by clean hits, HEDGE_COST per hedge
+    env_atomic64 hedge_credit;
+    env_atomic64 hedges;
+    env_atomic64 hedge_wins;
 
-    // Increment sample count for baseline stabilization
-    latency_sample_count++;
+    // Backend read targets, indexed as splitter->target_sets
+    struct netcas_target_dispatch targets[TARGET_SETS_MAX];
 
-    // Only establish baseline after stabilization period
-    if (latency_sample_count >= LATENCY_STABILIZATION_SAMPLES)
-    {
-        if (!latency_baseline_established)
-        {
-            // First time establishing baseline
-            if (rdma_latency_window_average > 0)
-            {
-                min_average_rdma_latency = rdma_latency_window_average;
-                latency_baseline_established = true;
-                NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Latency baseline established: %llu (after %llu samples)",
-                                          min_average_rdma_latency, latency_sample_count);
-            }
-            else
-            {
-                // Wait for valid latency value
-                NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Waiting for valid latency value (current: %llu)",
-                                          rdma_latency_window_average);
-            }
-        }
-        else
-        {
-            // Update min latency if current average is lower
-            if (rdma_latency_window_average < min_average_rdma_latency)
-            {
-                min_average_rdma_latency = rdma_latency_window_average;
-                NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: New min latency: %llu", min_average_rdma_latency);
-            }
-        }
-    }
+    // Statistics of cores, indexed by splitter->core_stats_slot - 1
+    struct netcas_core_counters cores[CORE_STATS_SLOTS];
 
-    NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: rdma_latency_window_average: %llu, baseline: %llu, established: %d",
-                              rdma_latency_window_average, min_average_rdma_latency, latency_baseline_established);
-}
+    // Requests seen since the last traced one
+    uint32_t trace_submits;
+    uint32_t trace_completions;
 
-/**
- * @brief Initialize the netcas splitter
- */
-void netcas_splitter_init(void)
-{
-    int i;
+    // Reset generation the owned state above was last reset for
+    uint32_t reset_gen;
+} __attribute__((aligned(64)));
 
-    env_rwlock_init(&split_ratio_lock);
-    optimal_split_ratio = SPLIT_RATIO_MAX; // Default 100% to cache
+/* Ring of trace records, the oldest ones are overwritten */
+struct netcas_trace
+{
+    env_spinlock lock;
+    uint32_t mask;
+    uint64_t head;          // Sequence number of the next record
+    struct netcas_trace_record records[];
+};
+
+/* Online calibration probe currently running */
+enum netcas_calibration_state
+{
+    CALIBRATION_IDLE,
+    CALIBRATION_PROBE_CACHE,   /* All hits to cache, measures A */
+    CALIBRATION_PROBE_BACKEND, /* All hits to backend, measures B */
+};
 
-    // Initialize mode management variables
-    netCAS_initialized = false;
-    split_ratio_calculated_in_stable = false;
-    current_mode = NETCAS_MODE_IDLE;
+/* Backend read target, owned by the monitor */
+struct netcas_target
+{
+    uint32_t bandwidth;             // Nominal, MiB/s
+    uint64_t last_completed_bytes;
+    uint64_t last_completions;
+    uint64_t last_latency_sum;
+    uint64_t throughput;            // Bytes/s in the last sample
+    uint64_t latency;               // ns, smoothed over samples
+    uint64_t sample_completions;    // Completions in the last sample
+    uint64_t sample_latency_sum;    // and their summed latency, ns
+    uint32_t samples;
+    bool congested;
+};
 
-    // Initialize RDMA throughput window
-    for (i = 0; i < RDMA_WINDOW_SIZE; ++i)
-        rdma_throughput_window[i] = 0;
-    rdma_window_sum = 0;
-    rdma_window_index = 0;
-    rdma_window_count = 0;
-    rdma_window_average = 0;
-    max_average_rdma_throughput = 0;
-
-    // Initialize RDMA latency window
-    for (i = 0; i < RDMA_WINDOW_SIZE; ++i)
-        rdma_latency_window[i] = 0;
-    rdma_latency_window_sum = 0;
-    rdma_latency_window_index = 0;
-    rdma_latency_window_count = 0;
-    rdma_latency_window_average = 0;
-    min_average_rdma_latency = UINT64_MAX;
+/*
+ * Read targets of one core. Configuration is requested under the splitter
+ * lock and applied by the monitor, which publishes the target weights for
+ * dispatchers. A slot is taken by a core on the first netcas_set_targets()
+ * and never freed while the splitter lives, only reused.
+ */
+struct netcas_target_set
+{
+    // Requested under lock
+    bool in_use;
+    bool changed;
+    ocf_core_id_t core_id;
+    uint32_t requested_count;
+    uint32_t requested_bandwidth[NETCAS_TARGET_MAX];
+
+    // Owned by the monitor
+    uint32_t count;
+    struct netcas_target target[NETCAS_TARGET_MAX];
+    uint64_t latency_reference;     // ns, lowest latency of a target, 0 if not known
+    uint64_t capacity_permil;       // Effective bandwidth over nominal
+
+    // Published by the monitor
+    env_atomic published_count;     // Read locklessly by dispatchers
+    env_atomic weight[NETCAS_TARGET_MAX]; // 0-10000 scale
+    struct netcas_target_stats stats[NETCAS_TARGET_MAX]; // Under splitter lock
+};
+
+/* Hill climbing controller state */
+struct netcas_hill_climb
+{
+    netCAS_mode_t mode;     // Mode the search was started in
+    uint64_t step;          // Current perturbation, 0-10000 scale
+    int direction;          // +1 towards cache, -1 towards backend
+    uint64_t prev_score;    // Score at the previous ratio, 0 if not measured yet
+    uint64_t score_sum;
+    uint32_t score_samples;
+    uint32_t settle;        // Samples left before scoring the current ratio
+};
 
-    // Initialize latency baseline management
-    latency_sample_count = 0;
-    latency_baseline_established = false;
+/*
+ * Per-cache splitter state. One instance is created for every cache in
+ * netcas_splitter_init() and hung off the adapter's cache_priv, so caches
+ * with different backend paths keep their own split ratio and mode machine.
+ */
+struct netcas_splitter
+{
+    ocf_cache_t cache;
+
+    // Runtime tunables - requested ones under lock, active ones owned by the monitor
+    env_spinlock lock;
+    struct netcas_params params;
+    struct netcas_params active_params;
+    env_atomic reset_requested;
+
+    // Bumped by the monitor on reset, each CPU then resets what it owns
+    env_atomic dispatch_reset_gen;
+
+    // NETCAS_HOOK_* called by the engine, bits are never cleared
+    env_atomic engine_hooks;
+
+    // Published by the monitor under lock
+    struct netcas_telemetry telemetry;
+
+    // Drop of throughput and increase of latency against baselines
+    uint64_t bw_drop_permil;
+    uint64_t latency_increase_permil;
+
+    // Moving average window for RDMA throughput
+    uint64_t rdma_throughput_window[RDMA_WINDOW_SIZE];
+    uint64_t rdma_window_index;
+    uint64_t rdma_window_sum;
+    uint64_t rdma_window_count;
+    uint64_t rdma_window_average;
+    uint64_t max_average_rdma_throughput;
+    uint64_t max_rdma_backend_share; // Backend share of the split at the peak
+
+    // Moving average window for RDMA latency
+    uint64_t rdma_latency_window[RDMA_WINDOW_SIZE];
+    uint64_t rdma_latency_window_index;
+    uint64_t rdma_latency_window_sum;
+    uint64_t rdma_latency_window_count;
+    uint64_t rdma_latency_window_average;
+
+    // Congestion detector, EWMA of backend latency against a decaying baseline
+    uint64_t latency_mean;         // ns
+    uint64_t latency_var;          // ns^2, of single samples
+    uint64_t latency_baseline;     // ns
+    uint64_t latency_baseline_var; // ns^2, variance of the mean outside congestion
+    uint64_t latency_sample_count;
+    bool latency_baseline_established;
+    bool latency_congested;        // Verdict held for the dwell time
+    uint64_t congestion_dwell_us;  // Time the opposite verdict has held
+    uint64_t latency_hold_us;      // Time the baseline stays put after congestion
+
+    // Mode management
+    bool netCAS_initialized;
+    bool split_ratio_calculated_in_stable; // Track if split ratio was calculated in stable mode
+    netCAS_mode_t current_mode;
+
+    // Optimal split ratio management
+    uint64_t optimal_split_ratio;    // Owned by the monitor, all size classes
+    int64_t size_offset[NETCAS_SIZE_MAX]; // Per size class deviation from the model
+    env_atomic64 published_split_ratio[NETCAS_SIZE_MAX]; // Read locklessly by dispatchers
+
+    // Per IO class split ratio bounds, min in upper and max in lower 16 bits
+    env_atomic io_class_bounds[OCF_USER_IO_CLASS_MAX];
+
+    // Monotonic time of the last sample, rates are taken over the real interval
+    uint64_t last_sample_ns;
+
+    // Timing control for monitor logging
+    uint64_t last_logged_time;
+
+    // Online calibration of cache-only and backend-only bandwidth
+    bool online_calibration;
+    enum netcas_calibration_state calibration_state;
+    uint32_t calibration_samples;  // Samples of the running probe
+    uint64_t calibration_idle_us;  // Time since the last probe
+    bool calibration_fed;          // Completions accounted since the last probe
+    uint64_t last_completed_bytes[NETCAS_PATH_MAX][NETCAS_SIZE_MAX];
+    uint64_t size_throughput[NETCAS_PATH_MAX][NETCAS_SIZE_MAX]; // Bytes/s in the last sample
+    uint64_t path_throughput[NETCAS_PATH_MAX]; // Bytes/s in the last sample, all sizes
+    struct netcas_bw_model bw_model;
+
+    // Dirty hits can't be offloaded, clean hits make up for their cache load
+    uint64_t last_hit_bytes;
+    uint64_t last_dirty_hit_bytes;
+    uint64_t dirty_share;          // Dirty share of hit bytes in the last sample, 0-10000
+
+    // Tail latency steering
+    uint64_t latency_hist_last[NETCAS_PATH_MAX][LATENCY_HIST_BUCKETS];
+    uint64_t latency_period_us;    // Time collected into the current p99 period
+    uint64_t path_p99[NETCAS_PATH_MAX];    // ns, measured over the last period
+    env_atomic64 p99_target;               // ns, 0 - no objective
+    int64_t tail_bias;                     // Added to the optimal ratio on publish
+
+    // Hedged reads, budget and delays published for the engine
+    env_atomic hedge_budget;               // Permil of clean hits, 0 - no hedging
+    env_atomic64 hedge_delay[NETCAS_PATH_MAX]; // ns, 0 - path not hedged yet
+
+    // Backend admission budget read by submitters, bytes/s, 0 - unthrottled
+    env_atomic64 backend_budget;
+    uint64_t budget_latency;       // Latency mean at the last budget change, ns
+
+    // Backend read targets of cores, core_target_set holds slot index + 1
+    struct netcas_target_set target_sets[TARGET_SETS_MAX];
+    uint8_t core_target_set[OCF_CORE_MAX];
+    uint64_t target_capacity_permil; // Scales backend bandwidth of the model
+    uint64_t healthy_latency_permil; // Latency of healthy targets over all of them
+
+    // Split ratio controller
+    env_atomic requested_policy;   // Set by netcas_set_policy()
+    enum netcas_policy policy;     // Applied by the monitor
+    struct netcas_hill_climb hill_climb;
+    uint64_t last_completed;
+    uint64_t completion_iops;      // Completed requests/s in the last sample
+
+    // Observed workload parallelism, bandwidth model lookup keys
+    uint64_t inflight_average;     // Requests in flight, smoothed over samples
+    uint64_t submitters_average;   // Distinct submitting tasks, smoothed over samples
+    uint64_t io_depth;             // Queue depth per submitter
+    uint64_t numjob;               // Number of submitters
+
+    // Optional trace of monitor samples and sampled requests
+    struct netcas_trace *trace;
+    env_atomic trace_sampling;     // One in that many requests traced, 0 - none
+
+    // Statistics reported by casadm, kept over splitter resets. Cores
+    // get per-CPU slots on their first request, core_stats_slot holds
+    // slot index + 1 or CORE_STATS_SHARED for core_counters.
+    env_atomic64 mode_time_us[NETCAS_MODE_MAX];
+    env_atomic core_stats_slot[OCF_CORE_MAX];
+    env_atomic core_stats_slots_used;
+    struct netcas_core_counters core_counters[OCF_CORE_MAX];
+
+    uint32_t cpus_no;
+    struct netcas_dispatch dispatch[];
+};
+
+static inline uint32_t trace_u32(uint64_t value)
+{
+    return value > TRACE_U32_MAX ? TRACE_U32_MAX : value;
+}
 
-    NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Splitter initialized");
+static inline uint16_t trace_u16(uint64_t value)
+{
+    return value > TRACE_U16_MAX ? TRACE_U16_MAX : value;
 }
 
 /**
- * @brief Set split ratio value with writer lock.
+ * @brief Append record to the trace ring, overwriting the oldest one.
+ * Called from completion context too, so interrupts are kept off.
  */
-static void split_set_optimal_ratio(uint64_t ratio)
+static void trace_add(struct netcas_splitter *splitter, struct netcas_trace_record *record)
 {
-    env_rwlock_write_lock(&split_ratio_lock);
-    optimal_split_ratio = ratio;
-    env_rwlock_write_unlock(&split_ratio_lock);
+    struct netcas_trace *trace = splitter->trace;
+    unsigned long flags;
+
+    record->timestamp_ns = env_get_monotonic_ns();
+    record->mode = splitter->current_mode;
+
+    env_spinlock_lock_irqsave(&trace->lock, flags);
+    record->seq = trace->head;
+    trace->records[trace->head & trace->mask] = *record;
+    trace->head++;
+    env_spinlock_unlock_irqrestore(&trace->lock, flags);
 }
 
 /**
- * @brief Calculate split ratio using the formula A/(A+B) * 10000.
- * This is the core formula for determining optimal split ratio.
- * Uses 0-10000 scale where 10000 = 100% for more accurate calculations.
+ * @brief Trace monitor sample with the ratio picked for it
  */
-static uint64_t calculate_split_ratio_formula(uint64_t bandwidth_cache_only, uint64_t bandwidth_backend_only)
+static void trace_sample(struct netcas_splitter *splitter, uint64_t rdma_throughput,
+                         uint64_t rdma_latency, uint64_t iops)
 {
-    uint64_t calculated_split;
+    struct netcas_trace_record record = { 0 };
 
-    /* Calculate optimal split ratio using formula A/(A+B) * 10000 */
-    calculated_split = (bandwidth_cache_only * SPLIT_RATIO_SCALE) / (bandwidth_cache_only + bandwidth_backend_only);
+    if (!splitter->trace)
+        return;
 
-    /* Ensure the result is within valid range (0-10000) */
-    if (calculated_split < SPLIT_RATIO_MIN)
-        calculated_split = SPLIT_RATIO_MIN;
-    if (calculated_split > SPLIT_RATIO_MAX)
-        calculated_split = SPLIT_RATIO_MAX;
+    record.type = NETCAS_TRACE_SAMPLE;
+    record.ratio = splitter->optimal_split_ratio;
+    record.sample.rdma_throughput = trace_u32(rdma_throughput);
+    record.sample.rdma_latency_ns = trace_u32(rdma_latency);
+    record.sample.iops = trace_u32(iops);
+    record.sample.bw_drop_permil = trace_u16(splitter->bw_drop_permil);
+    record.sample.latency_increase_permil = trace_u16(splitter->latency_increase_permil);
 
-    return calculated_split;
+    trace_add(splitter, &record);
 }
 
 /**
- * @brief Function to find the best split ratio for given IO depth and NumJob.
- * Based on the algorithm from netCAS_split.c
- * Returns split ratio in 0-10000 scale where 10000 = 100%.
+ * @brief Tell whether request seen by a dispatcher should be traced
  */
-static uint64_t find_best_split_ratio(uint64_t io_depth, uint64_t numjob, uint64_t drop_permil, uint64_t latency_increase_permil)
+static inline bool trace_request_sampled(struct netcas_splitter *splitter, uint32_t *counter)
 {
-    uint64_t bandwidth_cache_only;   /* A: IOPS when split ratio is 100% (all to cache) */
-    uint64_t bandwidth_backend_only; /* B: IOPS when split ratio is 0% (all to backend) */
-    uint64_t calculated_split;       /* Calculated optimal split ratio */
+    uint32_t sampling;
 
-    /* Get bandwidth for cache only (split ratio 100%) */
-    bandwidth_cache_only = (uint64_t)lookup_bandwidth(io_depth, numjob, 100);
-    /* Get bandwidth for backend only (split ratio 0%) */
-    bandwidth_backend_only = (uint64_t)lookup_bandwidth(io_depth, numjob, 0);
+    if (!splitter->trace)
+        return false;
 
-    // Apply latency increase percentage to backend bandwidth if there's congestion
-    if (latency_increase_permil > LATENCY_CONGESTION_THRESHOLD)
-    {
-        bandwidth_backend_only = (uint64_t)((bandwidth_backend_only * (1000 - drop_permil)) / 1000);
-    }
+    sampling = env_atomic_read(&splitter->trace_sampling);
+    if (!sampling || ++*counter < sampling)
+        return false;
 
-    /* Calculate optimal split ratio using the formula */
-    calculated_split = calculate_split_ratio_formula(bandwidth_cache_only, bandwidth_backend_only);
+    *counter = 0;
+    return true;
+}
 
-    // Log the calculation for debugging
-    NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Split ratio calculation - Cache BW: %llu, Backend BW: %llu, Drop: %llu%%, Result: %llu.%02llu%%",
-                              bandwidth_cache_only, bandwidth_backend_only, drop_permil / 10,
-                              calculated_split / 100, calculated_split % 100);
+/**
+ * @brief Trace routing decision or completion of a request
+ */
+static void trace_request(struct netcas_splitter *splitter, struct ocf_request *req,
+                          enum netcas_trace_type type, uint64_t ratio, enum netcas_path path,
+                          uint64_t latency_ns, unsigned cpu)
+{
+    struct netcas_trace_record record = { 0 };
+
+    record.type = type;
+    record.ratio = ratio;
+    record.request.bytes = req->byte_length;
+    record.request.latency_ns = trace_u32(latency_ns);
+    record.request.part_id = req->part_id;
+    record.request.path = path;
+    if (ocf_engine_is_miss(req))
+        record.request.hit = NETCAS_TRACE_MISS;
+    else
+        record.request.hit = req->info.dirty_any ? NETCAS_TRACE_HIT_DIRTY : NETCAS_TRACE_HIT_CLEAN;
+    record.request.cpu = cpu;
 
-    return calculated_split;
+    trace_add(splitter, &record);
 }
 
 /**
- * @brief Determine the current netCAS mode based on performance metrics
+ * @brief Update RDMA throughput window for moving average calculation
  */
-static netCAS_mode_t determine_netcas_mode(uint64_t curr_rdma_throughput, uint64_t curr_rdma_latency, uint64_t curr_iops, uint64_t bw_drop_permil, uint64_t latency_increase_permil)
+static void update_rdma_window(struct netcas_splitter *splitter, uint64_t curr_rdma_throughput)
 {
-    netCAS_mode_t previous_mode = current_mode;
-
-    // No Active RDMA traffic or no IOPS, set netCAS_mode to IDLE
-    if (curr_rdma_throughput <= RDMA_THRESHOLD && curr_iops <= IOPS_THRESHOLD)
+    // Update window
+    if (splitter->rdma_window_count < RDMA_WINDOW_SIZE)
     {
-        current_mode = NETCAS_MODE_IDLE;
+        splitter->rdma_window_count++;
     }
-    // Active RDMA traffic, determine the mode
     else
     {
-        // First time active RDMA traffic, set netCAS_mode to WARMUP
-        if (current_mode == NETCAS_MODE_IDLE)
-        {
-            // Idle -> Warmup
-            NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Mode changed from IDLE to WARMUP");
-            current_mode = NETCAS_MODE_WARMUP;
-            netCAS_initialized = false;
-        }
-        else if (current_mode == NETCAS_MODE_WARMUP)
-        {
-            // Warmup -> Stable
-            if (rdma_window_count >= RDMA_WINDOW_SIZE)
-            {
-                NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Mode changed from WARMUP to STABLE (window full)");
-                current_mode = NETCAS_MODE_STABLE;
-                split_ratio_calculated_in_stable = false; // Reset flag when entering stable mode
-            }
-            else
-            {
-                // Still in warmup, do nothing
-            }
-        }
-        else if (current_mode == NETCAS_MODE_CONGESTION &&
-                 (latency_increase_permil < LATENCY_RECOVERY_THRESHOLD))
-        {
-            // Congestion -> Stable (recovery if either metric recovers)
-            NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Mode changed from CONGESTION to STABLE (BW_Drop: %llu%%, Lat_Drop: %llu%%)",
-                                      bw_drop_permil / 10, latency_increase_permil / 10);
-            current_mode = NETCAS_MODE_STABLE;
-            split_ratio_calculated_in_stable = false; // Reset flag when entering stable mode
-        }
-        else if (current_mode == NETCAS_MODE_STABLE &&
-                 (latency_increase_permil > LATENCY_CONGESTION_THRESHOLD))
-        {
-            // Stable -> Congestion (enter if either metric exceeds threshold)
-            NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Mode changed from STABLE to CONGESTION (BW_Drop: %llu%%, Lat_Drop: %llu%%)",
-                                      bw_drop_permil / 10, latency_increase_permil / 10);
-            current_mode = NETCAS_MODE_CONGESTION;
-            split_ratio_calculated_in_stable = true; // Set flag when entering congestion
-        }
-        else if (CACHING_FAILED)
-        {
-            NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Mode changed to FAILURE");
-            current_mode = NETCAS_MODE_FAILURE;
-        }
+        splitter->rdma_window_sum -= splitter->rdma_throughput_window[splitter->rdma_window_index];
     }
+    splitter->rdma_throughput_window[splitter->rdma_window_index] = curr_rdma_throughput;
+    splitter->rdma_window_sum += curr_rdma_throughput;
+    splitter->rdma_window_average = splitter->rdma_window_sum / splitter->rdma_window_count;
+    splitter->rdma_window_index = (splitter->rdma_window_index + 1) % RDMA_WINDOW_SIZE;
 
-    // Log mode changes
-    if (previous_mode != current_mode)
+    if (splitter->max_average_rdma_throughput < splitter->rdma_window_average)
     {
-        NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Mode changed from %d to %d (RDMA: %llu, IOPS: %llu, BW_Drop: %llu%%, Lat_Drop: %llu%%)",
-                                  previous_mode, current_mode, curr_rdma_throughput, curr_iops, bw_drop_permil / 10, latency_increase_permil / 10);
+        splitter->max_average_rdma_throughput = splitter->rdma_window_average;
+        splitter->max_rdma_backend_share = SPLIT_RATIO_MAX - splitter->optimal_split_ratio;
+        NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: max_average_rdma_throughput: %llu", splitter->max_average_rdma_throughput);
     }
-
-    return current_mode;
 }
 
 /**
- * @brief Update the optimal split ratio based on current conditions
+ * @brief Update RDMA latency window for moving average calculation
  */
-void netcas_update_split_ratio(struct ocf_request *req)
+static void update_rdma_latency_window(struct netcas_splitter *splitter, uint64_t curr_rdma_latency)
 {
-    uint64_t new_split_ratio;
-    uint64_t curr_rdma_throughput = 0;
-    uint64_t curr_rdma_latency = 0;
-    uint64_t curr_iops = 0;
-    uint64_t elapsed_time = MONITOR_INTERVAL_MS; // Use the same interval as original
-    uint64_t bw_drop_permil = 0;
-    uint64_t latency_increase_permil = 0;
-    struct performance_metrics metrics;
-    netCAS_mode_t netCAS_mode;
-    uint64_t current_time = jiffies_to_msecs(jiffies);
-
-    // Only update monitor and split ratio at the proper intervals
-    if (current_time - last_monitor_update_time >= MONITOR_INTERVAL_MS)
+    // Update window
+    if (splitter->rdma_latency_window_count < RDMA_WINDOW_SIZE)
     {
-        // Measure current performance metrics using netCAS_monitor
-        metrics = measure_performance(elapsed_time);
-        curr_rdma_throughput = metrics.rdma_throughput;
-        curr_rdma_latency = metrics.rdma_latency;
-        curr_iops = metrics.iops;
-
-        // Update RDMA throughput window for moving average calculation
-        update_rdma_window(curr_rdma_throughput);
-        // Update RDMA latency window for moving average calculation
-        update_rdma_latency_window(curr_rdma_latency);
-
-        // Calculate drop percentage if we have enough data
-        if (max_average_rdma_throughput > 0)
-        {
-            bw_drop_permil = ((max_average_rdma_throughput - rdma_window_average) * 1000) / max_average_rdma_throughput;
-        }
+        splitter->rdma_latency_window_count++;
+    }
+    else
+    {
+        splitter->rdma_latency_window_sum -= splitter->rdma_latency_window[splitter->rdma_latency_window_index];
+    }
+    splitter->rdma_latency_window[splitter->rdma_latency_window_index] = curr_rdma_latency;
+    splitter->rdma_latency_window_sum += curr_rdma_latency;
+    splitter->rdma_latency_window_average = splitter->rdma_latency_window_sum / splitter->rdma_latency_window_count;
+    splitter->rdma_latency_window_index = (splitter->rdma_latency_window_index + 1) % RDMA_WINDOW_SIZE;
+}
 
-        // Only calculate latency increase if baseline is established
-        if (latency_baseline_established && min_average_rdma_latency < UINT64_MAX)
-        {
-            latency_increase_permil = ((rdma_latency_window_average - min_average_rdma_latency) * 1000) / min_average_rdma_latency;
-        }
-        else
-        {
-            latency_increase_permil = 0; // No baseline yet
-        }
+/**
+ * @brief Track EWMA mean and variance of backend latency samples, and move
+ * the baseline: down to the mean at once, up towards it slowly, so it
+ * re-learns a new normal after e.g. a topology change. While congestion
+ * costs throughput and for a while after it ends, the baseline stays put,
+ * so neither the congested latency nor the backlog draining afterwards
+ * moves it. Samples without backend completions carry no latency and are
+ * skipped.
+ */
+static void update_latency_baseline(struct netcas_splitter *splitter, uint64_t curr_rdma_latency,
+                                    uint64_t bw_drop_permil, uint64_t elapsed_us)
+{
+    int64_t diff, step;
+    uint64_t weight, rise;
 
-        // Determine current mode based on performance metrics
-        netCAS_mode = determine_netcas_mode(curr_rdma_throughput, curr_rdma_latency, curr_iops, bw_drop_permil, latency_increase_permil);
+    if (!curr_rdma_latency)
+        return;
 
-        // Update split ratio based on mode
-        switch (netCAS_mode)
-        {
-        case NETCAS_MODE_IDLE:
-            if (!netCAS_initialized)
-            {
-                // Initialize with default values
-                optimal_split_ratio = SPLIT_RATIO_MAX;
-                split_set_optimal_ratio(optimal_split_ratio);
-                netCAS_initialized = true;
-                NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: IDLE mode - initialized with default split ratio");
-            }
-            break;
+    if (!splitter->latency_sample_count++)
+    {
+        splitter->latency_mean = curr_rdma_latency;
+        splitter->latency_var = 0;
+        return;
+    }
 
-        case NETCAS_MODE_WARMUP:
-            // In warmup mode, calculate split ratio without drop (assuming no contention in startup)
-            new_split_ratio = find_best_split_ratio(IO_DEPTH, NUM_JOBS, 0, 0);
-            if (new_split_ratio != optimal_split_ratio)
-            {
-                optimal_split_ratio = new_split_ratio;
-                split_set_optimal_ratio(optimal_split_ratio);
-                NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: WARMUP mode - Updated split ratio to: %llu.%02llu%% (RDMA: %llu, IOPS: %llu)",
-                                          new_split_ratio / 100, new_split_ratio % 100, curr_rdma_throughput, curr_iops);
-            }
-            break;
+    // Sample weight follows the time it covers, so the detector reacts alike at any interval
+    weight = clamp_t(uint64_t, elapsed_us * 1000 / LATENCY_EWMA_US, 1, 1000);
+    diff = (int64_t)curr_rdma_latency - (int64_t)splitter->latency_mean;
+    step = diff * (int64_t)weight / 1000;
+    splitter->latency_mean += step;
+    splitter->latency_var = (splitter->latency_var + (uint64_t)(diff * step)) * (1000 - weight) / 1000;
 
-        case NETCAS_MODE_STABLE:
-            // Only calculate split ratio once in stable mode
-            if (!split_ratio_calculated_in_stable && rdma_window_count >= RDMA_WINDOW_SIZE)
-            {
-                new_split_ratio = find_best_split_ratio(IO_DEPTH, NUM_JOBS, bw_drop_permil, latency_increase_permil);
-                optimal_split_ratio = new_split_ratio;
-                split_set_optimal_ratio(optimal_split_ratio);
-                split_ratio_calculated_in_stable = true; // Mark as calculated
-                NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: STABLE mode - Calculated split ratio: %llu.%02llu%% (RDMA: %llu, IOPS: %llu, Drop: %llu%%)",
-                                          new_split_ratio / 100, new_split_ratio % 100, curr_rdma_throughput, curr_iops, bw_drop_permil / 10);
-            }
-            break;
+    // Noise is learnt only while latency is plainly normal. Variance of an
+    // EWMA with weight w is w / (2 - w) times that of the samples.
+    if (!splitter->latency_congested && !splitter->congestion_dwell_us && !splitter->latency_hold_us)
+        splitter->latency_baseline_var = splitter->latency_var * weight / (2000 - weight);
 
-        case NETCAS_MODE_CONGESTION:
-            // Continuously calculate split ratio in congestion mode
-            if (rdma_window_count >= RDMA_WINDOW_SIZE)
-            {
-                new_split_ratio = find_best_split_ratio(IO_DEPTH, NUM_JOBS, bw_drop_permil, latency_increase_permil);
+    if (!splitter->latency_baseline_established)
+    {
+        if (splitter->latency_sample_count < LATENCY_STABILIZATION_SAMPLES)
+            return;
+
+        splitter->latency_baseline = max_t(uint64_t, splitter->latency_mean, 1);
+        splitter->latency_baseline_established = true;
+        NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Latency baseline established: %llu (after %llu samples)",
+                                  splitter->latency_baseline, splitter->latency_sample_count);
+        return;
+    }
 
-                // Update the split ratio if it changed
-                if (new_split_ratio != optimal_split_ratio)
-                {
-                    optimal_split_ratio = new_split_ratio;
-                    split_set_optimal_ratio(new_split_ratio);
-                    NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: CONGESTION mode - Updated split ratio to: %llu.%02llu%% (RDMA: %llu, IOPS: %llu, Drop: %llu%%)",
-                                              new_split_ratio / 100, new_split_ratio % 100, curr_rdma_throughput, curr_iops, bw_drop_permil / 10);
-                }
-            }
-            break;
+    // Healthy targets alone carry a different load than the full set, the
+    // baseline waits for drained ones to come back
+    if (splitter->healthy_latency_permil < TARGET_CAPACITY_SCALE)
+        return;
 
-        case NETCAS_MODE_FAILURE:
-            // In failure mode, keep current ratio or set to safe default
-            NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: FAILURE mode - Keeping current split ratio: %llu.%02llu%% (RDMA: %llu, IOPS: %llu)",
-                                      optimal_split_ratio / 100, optimal_split_ratio % 100, curr_rdma_throughput, curr_iops);
-            break;
-        }
+    if (splitter->latency_congested && bw_drop_permil >= BW_RECOVERY_THRESHOLD)
+        return;
 
-        // Update the last monitor update time
-        last_monitor_update_time = current_time;
+    if (splitter->latency_hold_us)
+    {
+        splitter->latency_hold_us -= min_t(uint64_t, splitter->latency_hold_us, elapsed_us);
+        return;
     }
-    if (current_time - last_logged_time >= LOG_INTERVAL_MS)
+
+    if (splitter->latency_mean < splitter->latency_baseline)
     {
-        printk("netCAS: Current metrics - RDMA: %llu, RDMA_Lat: %llu (baseline: %llu), IOPS: %llu, BW_Drop: %llu%%, Lat_Inc: %llu%%, Mode: %d, Split Ratio: %llu.%02llu%%",
-               curr_rdma_throughput, rdma_latency_window_average, min_average_rdma_latency, curr_iops, bw_drop_permil / 10, latency_increase_permil / 10, current_mode, (unsigned long long)optimal_split_ratio / 100, (unsigned long long)optimal_split_ratio % 100);
-        last_logged_time = current_time;
-        printk("MONITOR: query_load_admit returning: %llu\n", (unsigned long long)optimal_split_ratio);
+        splitter->latency_baseline = max_t(uint64_t, splitter->latency_mean, 1);
+        return;
     }
+
+    rise = (splitter->latency_mean - splitter->latency_baseline) * min_t(uint64_t, elapsed_us, LATENCY_RELEARN_US) /
+           LATENCY_RELEARN_US;
+    splitter->latency_baseline += rise;
 }
 
 /**
- * @brief Calculate GCD using Euclidean algorithm
+ * @brief Judge congestion from the latency mean against the baseline. The
+ * mean has to be over both sigma_enter standard deviations of the mean and
+ * the congestion threshold to enter, and within both sigma_exit deviations
+ * or the recovery threshold to leave. Either verdict has to hold for its
+ * dwell time before the state changes, so single noisy samples don't flap
+ * the mode. Latency which grows while the backend keeps its peak throughput
+ * is queueing under load, not congestion, so entering also takes a
+ * throughput drop.
  */
-static uint32_t calculate_gcd(uint32_t a, uint32_t b)
+static void update_latency_congestion(struct netcas_splitter *splitter, uint64_t bw_drop_permil,
+                                      uint64_t elapsed_us)
 {
-    uint32_t temp;
+    uint64_t baseline = splitter->latency_baseline;
+    uint64_t mean_var = splitter->latency_baseline_var;
+    uint64_t excess, sigmas, dwell_us;
+    uint32_t threshold;
+    bool verdict;
 
-    if (a > 0 && b > 0)
+    if (!splitter->latency_baseline_established)
+        return;
+
+    excess = splitter->latency_mean > baseline ? splitter->latency_mean - baseline : 0;
+    splitter->latency_increase_permil = excess * 1000 / baseline;
+
+    if (splitter->latency_congested)
     {
-        while (b != 0)
-        {
-            temp = b;
-            b = a % b;
-            a = temp;
-        }
-        return a;
+        sigmas = LATENCY_SIGMA_EXIT;
+        threshold = splitter->active_params.latency_recovery_threshold;
+        verdict = excess * excess > sigmas * sigmas * mean_var &&
+                  splitter->latency_increase_permil >= threshold;
+        dwell_us = CONGESTION_EXIT_DWELL_US;
     }
-    return 1;
+    else
+    {
+        sigmas = LATENCY_SIGMA_ENTER;
+        threshold = splitter->active_params.latency_congestion_threshold;
+        verdict = excess * excess > sigmas * sigmas * mean_var &&
+                  splitter->latency_increase_permil > threshold &&
+                  bw_drop_permil > BW_CONGESTION_THRESHOLD;
+        dwell_us = CONGESTION_ENTER_DWELL_US;
+    }
+
+    if (verdict == splitter->latency_congested)
+    {
+        splitter->congestion_dwell_us = 0;
+        return;
+    }
+
+    splitter->congestion_dwell_us += elapsed_us;
+    if (splitter->congestion_dwell_us < dwell_us)
+        return;
+
+    splitter->latency_congested = verdict;
+    splitter->congestion_dwell_us = 0;
+    if (!verdict)
+        splitter->latency_hold_us = LATENCY_HOLD_US;
+
+    NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Latency %s (mean: %llu ns, baseline: %llu ns, sigma^2: %llu)",
+                              verdict ? "congested" : "recovered", splitter->latency_mean, baseline, mean_var);
 }
 
 /**
- * @brief Initialize or recalculate the splitting pattern
+ * @brief Split ratio handed to dispatchers of a size class, optimal ratio
+ * moved by the size class offset and the tail latency bias. Dispatchers
+ * split clean hits only, so the ratio is scaled to leave the cache share
+ * of all hits at the target, given the dirty ones already go to cache.
  */
-static void initialize_split_pattern(uint64_t split_ratio)
+static uint64_t effective_split_ratio(struct netcas_splitter *splitter, enum netcas_size_class size)
 {
-    uint32_t gcd;
-    uint32_t a = (uint32_t)(split_ratio / 100); // Convert from 0-10000 scale to 0-100
-    uint32_t b = WINDOW_SIZE - a;
+    int64_t ratio = (int64_t)splitter->optimal_split_ratio + splitter->size_offset[size] +
+                    splitter->tail_bias;
+    int64_t dirty = splitter->dirty_share;
 
-    // Calculate GCD
-    gcd = calculate_gcd(a, b);
+    // Pinned ratio is taken as is
+    if (splitter->active_params.pinned_ratio != NETCAS_RATIO_UNPINNED)
+        return splitter->active_params.pinned_ratio;
 
-    // Calculate pattern size (limited by MAX_PATTERN_SIZE)
-    pattern_size = (a + (WINDOW_SIZE - a)) / gcd;
-    if (pattern_size > MAX_PATTERN_SIZE)
-    {
-        pattern_size = MAX_PATTERN_SIZE;
-    }
+    if (dirty < SPLIT_RATIO_MAX)
+        ratio = (ratio - dirty) * SPLIT_RATIO_MAX / (SPLIT_RATIO_MAX - dirty);
+
+    if (ratio > SPLIT_RATIO_MAX)
+        ratio = SPLIT_RATIO_MAX;
+    if (ratio < SPLIT_RATIO_MIN)
+        ratio = SPLIT_RATIO_MIN;
 
-    // Calculate cache and backend requests in pattern
-    pattern_cache = (a * pattern_size) / WINDOW_SIZE;
-    pattern_backend = pattern_size - pattern_cache;
+    return ratio;
+}
+
+/**
+ * @brief Publish current split ratio. Dispatchers pick it up with a single
+ * atomic read at their next window boundary.
+ */
+static void split_publish_ratio(struct netcas_splitter *splitter)
+{
+    int size;
 
-    // Reset counters
-    total_requests = 0;
-    cache_requests = 0;
-    backend_requests = 0;
+    // Calibration probe owns the published ratio until it finishes
+    if (splitter->calibration_state != CALIBRATION_IDLE)
+        return;
 
-    // Initialize quotas
-    cache_quota = a;
-    backend_quota = WINDOW_SIZE - a;
-    pattern_position = 0;
+    for (size = 0; size < NETCAS_SIZE_MAX; ++size)
+        env_atomic64_set(&splitter->published_split_ratio[size], effective_split_ratio(splitter, size));
 }
 
 /**
- * @brief Decide whether to send request to cache or backend (Original pattern-based version)
- * @param req The OCF request
- * @return true if request should go to backend, false for cache
+ * @brief Publish the same forced ratio for all size classes
  */
-bool netcas_should_send_to_backend(struct ocf_request *req)
+static void split_publish_forced_ratio(struct netcas_splitter *splitter, uint64_t ratio)
 {
-    bool send_to_backend;
-    uint32_t expected_cache_ratio;
-    uint32_t expected_backend_ratio;
-    uint64_t current_split_ratio;
-    uint32_t split_ratio_percent;
+    int size;
 
-    // Update split ratio based on current performance metrics
-    netcas_update_split_ratio(req);
+    for (size = 0; size < NETCAS_SIZE_MAX; ++size)
+        env_atomic64_set(&splitter->published_split_ratio[size], ratio);
+}
 
-    // Get current optimal split ratio
-    current_split_ratio = optimal_split_ratio;
-    // Convert from 0-10000 scale to 0-100 for internal calculations
-    split_ratio_percent = (uint32_t)(current_split_ratio / 100);
+/**
+ * @brief Set and publish new optimal split ratio
+ */
+static void split_set_optimal_ratio(struct netcas_splitter *splitter, uint64_t ratio)
+{
+    splitter->optimal_split_ratio = ratio;
+    split_publish_ratio(splitter);
+}
 
-    // Log current split ratio for debugging
-    // NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Current split ratio: %llu.%02llu%% (percent: %u)",
-    //                           current_split_ratio / 100, current_split_ratio % 100, split_ratio_percent);
+/**
+ * @brief Restart hill climbing search from the current optimal ratio
+ */
+static void hill_climb_reset(struct netcas_splitter *splitter)
+{
+    struct netcas_hill_climb *hc = &splitter->hill_climb;
+
+    hc->mode = splitter->current_mode;
+    hc->step = HILL_CLIMB_STEP_MAX;
+    hc->direction = -1; // Default ratio is all to cache, only way is down
+    hc->prev_score = 0;
+    hc->score_sum = 0;
+    hc->score_samples = 0;
+    hc->settle = HILL_CLIMB_SETTLE_SAMPLES;
+}
 
-    // Initialize or recalculate pattern when needed
-    if (request_counter % WINDOW_SIZE == 0 || pattern_size == 0)
+/**
+ * @brief Reset per-CPU achieved split counters. Split patterns and target
+ * credits are written by their CPU only, it resets them on its next request.
+ */
+static void dispatch_reset(struct netcas_dispatch *dispatch)
+{
+    int path, size, bucket, set, target;
+
+    env_atomic64_set(&dispatch->cache_hits, 0);
+    env_atomic64_set(&dispatch->backend_hits, 0);
+    env_atomic64_set(&dispatch->dirty_hits, 0);
+    env_atomic64_set(&dispatch->dirty_hit_bytes, 0);
+    env_atomic64_set(&dispatch->hedge_credit, 0);
+    env_atomic64_set(&dispatch->hedges, 0);
+    env_atomic64_set(&dispatch->hedge_wins, 0);
+    for (path = 0; path < NETCAS_PATH_MAX; ++path)
     {
-        initialize_split_pattern(current_split_ratio);
+        env_atomic64_set(&dispatch->hit_bytes[path], 0);
+        for (size = 0; size < NETCAS_SIZE_MAX; ++size)
+            env_atomic64_set(&dispatch->completed_bytes[path][size], 0);
     }
+    env_atomic64_set(&dispatch->submitted, 0);
+    env_atomic64_set(&dispatch->completed, 0);
+    dispatch->submitter_mask = 0;
 
-    // Increment counters
-    request_counter++;
-    total_requests++;
-
-    // Check for miss first
-    if (ocf_engine_is_miss(req))
+    for (path = 0; path < NETCAS_PATH_MAX; ++path)
     {
-        NETCAS_SPLITTER_DEBUG_LOG(NULL, "Backend (miss)");
-        return true;
+        for (bucket = 0; bucket < LATENCY_HIST_BUCKETS; ++bucket)
+            env_atomic64_set(&dispatch->latency_hist[path][bucket], 0);
     }
 
-    // Calculate expected ratios
-    expected_cache_ratio = (total_requests * split_ratio_percent) / WINDOW_SIZE;
-    expected_backend_ratio = total_requests - expected_cache_ratio;
-
-    // Determine where to send request based on current distribution
-    if (cache_requests < expected_cache_ratio)
+    for (set = 0; set < TARGET_SETS_MAX; ++set)
     {
-        // Cache requests are below expected ratio
-        send_to_backend = false;
+        for (target = 0; target < NETCAS_TARGET_MAX; ++target)
+        {
+            env_atomic64_set(&dispatch->targets[set].completed_bytes[target], 0);
+            env_atomic64_set(&dispatch->targets[set].completions[target], 0);
+            env_atomic64_set(&dispatch->targets[set].latency_sum[target], 0);
+        }
+    }
+}
+
+/**
+ * @brief Reset split patterns and target credits of this CPU if the monitor
+ * reset the splitter since they were last used. Called by the owner CPU.
+ */
+static inline void dispatch_sync(struct netcas_splitter *splitter, struct netcas_dispatch *dispatch)
+{
+    uint32_t gen = env_atomic_read(&splitter->dispatch_reset_gen);
+    int set;
+
+    if (dispatch->reset_gen == gen)
+        return;
+
+    env_memset(dispatch->pattern, sizeof(dispatch->pattern), 0);
+    for (set = 0; set < TARGET_SETS_MAX; ++set)
+        env_memset(dispatch->targets[set].credit, sizeof(dispatch->targets[set].credit), 0);
+    dispatch->reset_gen = gen;
+}
+
+/**
+ * @brief Publish weights of the targets of a set, proportional to their
+ * effective bandwidth. Congested targets count with the bandwidth scaled
+ * by how much slower than the fastest target they are, and are drained to
+ * a probe weight, so the healthy ones take their share and the congested
+ * ones are still measured for recovery.
+ */
+static void target_set_publish(struct netcas_target_set *set)
+{
+    uint64_t effective[NETCAS_TARGET_MAX];
+    uint64_t weight[NETCAS_TARGET_MAX];
+    uint64_t effective_sum = 0, nominal_sum = 0, weight_sum = 0;
+    uint64_t deliverable;
+    int i;
+
+    for (i = 0; i < set->count; ++i)
+    {
+        struct netcas_target *target = &set->target[i];
+
+        effective[i] = target->bandwidth;
+        if (target->congested)
+            effective[i] = effective[i] * set->latency_reference / max_t(uint64_t, target->latency, 1);
+
+        effective_sum += effective[i];
+        nominal_sum += target->bandwidth;
     }
-    else if (backend_requests < expected_backend_ratio)
+
+    for (i = 0; i < set->count; ++i)
     {
-        // Backend requests are below expected ratio
-        send_to_backend = true;
+        weight[i] = effective_sum ? effective[i] * SPLIT_RATIO_MAX / effective_sum : 0;
+        if (set->target[i].congested)
+            weight[i] = min_t(uint64_t, weight[i], TARGET_PROBE_WEIGHT);
+
+        // Every target keeps some reads, so its latency stays measured
+        weight[i] = max_t(uint64_t, weight[i], 1);
+        weight_sum += weight[i];
+        env_atomic_set(&set->weight[i], weight[i]);
     }
-    else
+
+    // Drained targets carry only the probe weight, the set delivers what
+    // its most loaded target can take at the published weights
+    deliverable = effective_sum;
+    for (i = 0; i < set->count; ++i)
+        deliverable = min_t(uint64_t, deliverable, effective[i] * weight_sum / weight[i]);
+
+    set->capacity_permil = nominal_sum ? deliverable * TARGET_CAPACITY_SCALE / nominal_sum :
+                                         TARGET_CAPACITY_SCALE;
+    env_atomic_set(&set->published_count, set->count);
+}
+
+/**
+ * @brief Read completion counters of a target summed over all CPUs
+ */
+static void target_read_counters(struct netcas_splitter *splitter, int set_index, int index,
+                                  uint64_t *completed_bytes, uint64_t *completions,
+                                  uint64_t *latency_sum)
+{
+    struct netcas_target_dispatch *dispatch;
+    int i;
+
+    *completed_bytes = 0;
+    *completions = 0;
+    *latency_sum = 0;
+
+    for (i = 0; i < splitter->cpus_no; ++i)
+    {
+        dispatch = &splitter->dispatch[i].targets[set_index];
+        *completed_bytes += env_atomic64_read(&dispatch->completed_bytes[index]);
+        *completions += env_atomic64_read(&dispatch->completions[index]);
+        *latency_sum += env_atomic64_read(&dispatch->latency_sum[index]);
+    }
+}
+
+/**
+ * @brief Forget measured state of the targets of a set and publish weights
+ * of their nominal bandwidth
+ */
+static void target_set_reset(struct netcas_splitter *splitter, int set_index)
+{
+    struct netcas_target_set *set = &splitter->target_sets[set_index];
+    struct netcas_target *target;
+    int i;
+
+    for (i = 0; i < NETCAS_TARGET_MAX; ++i)
+    {
+        target = &set->target[i];
+        target_read_counters(splitter, set_index, i, &target->last_completed_bytes,
+                             &target->last_completions, &target->last_latency_sum);
+        target->throughput = 0;
+        target->latency = 0;
+        target->samples = 0;
+        target->congested = false;
+    }
+    set->latency_reference = 0;
+
+    target_set_publish(set);
+}
+
+/**
+ * @brief Bring the split pattern, windows and mode machine back to defaults.
+ */
+static void splitter_reset_state(struct netcas_splitter *splitter)
+{
+    int i;
+
+    for (i = 0; i < splitter->cpus_no; ++i)
+        dispatch_reset(&splitter->dispatch[i]);
+    env_atomic_inc(&splitter->dispatch_reset_gen);
+
+    // Reset online calibration, measured bandwidth model is dropped as well
+    splitter->calibration_state = CALIBRATION_IDLE;
+    splitter->calibration_samples = 0;
+    splitter->calibration_idle_us = 0;
+    splitter->calibration_fed = false;
+    env_memset(splitter->last_completed_bytes, sizeof(splitter->last_completed_bytes), 0);
+    env_memset(splitter->size_throughput, sizeof(splitter->size_throughput), 0);
+    env_memset(splitter->path_throughput, sizeof(splitter->path_throughput), 0);
+    env_memset(splitter->size_offset, sizeof(splitter->size_offset), 0);
+    netcas_bw_model_init(&splitter->bw_model);
+    splitter->last_hit_bytes = 0;
+    splitter->last_dirty_hit_bytes = 0;
+    splitter->dirty_share = 0;
+
+    // Reset measured state of read targets, their configuration is kept
+    for (i = 0; i < TARGET_SETS_MAX; ++i)
+        target_set_reset(splitter, i);
+    splitter->target_capacity_permil = TARGET_CAPACITY_SCALE;
+    splitter->healthy_latency_permil = TARGET_CAPACITY_SCALE;
+
+    // Reset tail latency steering, p99 objective is kept
+    for (i = 0; i < NETCAS_PATH_MAX; ++i)
+    {
+        env_memset(splitter->latency_hist_last[i], sizeof(splitter->latency_hist_last[i]), 0);
+        splitter->path_p99[i] = 0;
+        env_atomic64_set(&splitter->hedge_delay[i], 0);
+    }
+    splitter->latency_period_us = 0;
+    splitter->tail_bias = 0;
+    env_atomic64_set(&splitter->backend_budget, 0);
+    splitter->budget_latency = 0;
+
+    // Reset completion rate, selected policy and IO class bounds are kept
+    splitter->last_completed = 0;
+    splitter->completion_iops = 0;
+
+    // Reset workload parallelism
+    splitter->inflight_average = 0;
+    splitter->submitters_average = 0;
+    splitter->io_depth = PARALLELISM_DEFAULT_IO_DEPTH;
+    splitter->numjob = PARALLELISM_DEFAULT_NUMJOB;
+
+    // Reset optimal split ratio to default (100% to cache)
+    split_set_optimal_ratio(splitter, SPLIT_RATIO_MAX);
+
+    // Reset mode management variables
+    splitter->netCAS_initialized = false;
+    splitter->split_ratio_calculated_in_stable = false;
+    splitter->current_mode = NETCAS_MODE_IDLE;
+
+    // Reset RDMA throughput window
+    for (i = 0; i < RDMA_WINDOW_SIZE; ++i)
+        splitter->rdma_throughput_window[i] = 0;
+    splitter->rdma_window_sum = 0;
+    splitter->rdma_window_index = 0;
+    splitter->rdma_window_count = 0;
+    splitter->rdma_window_average = 0;
+    splitter->max_average_rdma_throughput = 0;
+    splitter->max_rdma_backend_share = 0;
+    splitter->last_logged_time = 0;
+
+    // Reset RDMA latency window
+    for (i = 0; i < RDMA_WINDOW_SIZE; ++i)
+        splitter->rdma_latency_window[i] = 0;
+    splitter->rdma_latency_window_sum = 0;
+    splitter->rdma_latency_window_index = 0;
+    splitter->rdma_latency_window_count = 0;
+    splitter->rdma_latency_window_average = 0;
+
+    // Reset congestion detector
+    splitter->latency_mean = 0;
+    splitter->latency_var = 0;
+    splitter->latency_baseline = 0;
+    splitter->latency_baseline_var = 0;
+    splitter->latency_sample_count = 0;
+    splitter->latency_baseline_established = false;
+    splitter->latency_congested = false;
+    splitter->congestion_dwell_us = 0;
+    splitter->latency_hold_us = 0;
+    splitter->bw_drop_permil = 0;
+    splitter->latency_increase_permil = 0;
+
+    hill_climb_reset(splitter);
+}
+
+/**
+ * @brief Create the netcas splitter context for a cache
+ * @param cache Cache the splitter is attached to
+ * @param splitter Output - newly allocated splitter context
+ * @return 0 on success, -OCF_ERR_NO_MEM when allocation failed
+ */
+int netcas_splitter_init(ocf_cache_t cache, struct netcas_splitter **splitter)
+{
+    struct netcas_splitter *new_splitter;
+    uint32_t cpus_no = env_get_execution_context_count();
+    int i;
+
+    new_splitter = env_vzalloc(sizeof(*new_splitter) +
+                               cpus_no * sizeof(new_splitter->dispatch[0]));
+    if (!new_splitter)
+        return -OCF_ERR_NO_MEM;
+
+    new_splitter->cache = cache;
+    new_splitter->cpus_no = cpus_no;
+
+    if (env_spinlock_init(&new_splitter->lock))
+    {
+        env_vfree(new_splitter);
+        return -OCF_ERR_NO_MEM;
+    }
+
+    new_splitter->params.monitor_interval_ms = MONITOR_INTERVAL_MS;
+    new_splitter->params.log_interval_ms = LOG_INTERVAL_MS;
+    new_splitter->params.latency_congestion_threshold = LATENCY_CONGESTION_THRESHOLD;
+    new_splitter->params.latency_recovery_threshold = LATENCY_RECOVERY_THRESHOLD;
+    new_splitter->params.pinned_ratio = NETCAS_RATIO_UNPINNED;
+    new_splitter->params.hedge_percentile = HEDGE_PERCENTILE;
+    new_splitter->active_params = new_splitter->params;
+
+    new_splitter->online_calibration = true;
+    env_atomic_set(&new_splitter->requested_policy, NETCAS_POLICY_FORMULA);
+    new_splitter->policy = NETCAS_POLICY_FORMULA;
+    for (i = 0; i < OCF_USER_IO_CLASS_MAX; ++i)
+        env_atomic_set(&new_splitter->io_class_bounds[i], IO_CLASS_BOUNDS(SPLIT_RATIO_MIN, SPLIT_RATIO_MAX));
+    splitter_reset_state(new_splitter);
+
+    *splitter = new_splitter;
+
+    NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Splitter initialized for %s", ocf_cache_get_name(cache));
+
+    return 0;
+}
+
+/**
+ * @brief Destroy the netcas splitter context. Called on cache stop, once
+ * no more requests can reach netcas_should_send_to_backend().
+ */
+void netcas_splitter_deinit(struct netcas_splitter *splitter)
+{
+    if (!splitter)
+        return;
+
+    if (splitter->trace)
+    {
+        env_spinlock_destroy(&splitter->trace->lock);
+        env_vfree(splitter->trace);
+    }
+
+    env_spinlock_destroy(&splitter->lock);
+    env_vfree(splitter);
+}
+
+/**
+ * @brief Bound share of hits of an IO class served by cache. Min equal to
+ * max pins the class to a fixed split, e.g. 10000 keeps it on local cache.
+ * Takes effect at the next window of every dispatcher.
+ * @return 0 on success, -OCF_ERR_INVAL on invalid class or bounds
+ */
+int netcas_set_io_class_bounds(struct netcas_splitter *splitter, ocf_part_id_t part_id,
+                               uint16_t min_ratio, uint16_t max_ratio)
+{
+    if (part_id >= OCF_USER_IO_CLASS_MAX)
+        return -OCF_ERR_INVAL;
+    if (min_ratio > max_ratio || max_ratio > SPLIT_RATIO_MAX)
+        return -OCF_ERR_INVAL;
+
+    env_atomic_set(&splitter->io_class_bounds[part_id], IO_CLASS_BOUNDS(min_ratio, max_ratio));
+
+    return 0;
+}
+
+void netcas_get_io_class_bounds(struct netcas_splitter *splitter, ocf_part_id_t part_id,
+                                uint16_t *min_ratio, uint16_t *max_ratio)
+{
+    int bounds = IO_CLASS_BOUNDS(SPLIT_RATIO_MIN, SPLIT_RATIO_MAX);
+
+    if (part_id < OCF_USER_IO_CLASS_MAX)
+        bounds = env_atomic_read(&splitter->io_class_bounds[part_id]);
+
+    *min_ratio = IO_CLASS_BOUNDS_MIN(bounds);
+    *max_ratio = IO_CLASS_BOUNDS_MAX(bounds);
+}
+
+/**
+ * @brief Set p99 completion latency objective. Safe to call at any time.
+ */
+void netcas_set_p99_target(struct netcas_splitter *splitter, uint64_t target_ns)
+{
+    env_atomic64_set(&splitter->p99_target, target_ns);
+}
+
+uint64_t netcas_get_p99_target(struct netcas_splitter *splitter)
+{
+    return env_atomic64_read(&splitter->p99_target);
+}
+
+uint64_t netcas_get_path_p99(struct netcas_splitter *splitter, enum netcas_path path)
+{
+    return splitter->path_p99[path];
+}
+
+/**
+ * @brief Select split ratio controller. Safe to call at any time, the
+ * monitor switches over at its next step.
+ */
+void netcas_set_policy(struct netcas_splitter *splitter, enum netcas_policy policy)
+{
+    if (policy >= NETCAS_POLICY_MAX)
+        return;
+
+    env_atomic_set(&splitter->requested_policy, policy);
+}
+
+enum netcas_policy netcas_get_policy(struct netcas_splitter *splitter)
+{
+    return env_atomic_read(&splitter->requested_policy);
+}
+
+/**
+ * @brief Update delivered throughput of each path from completion counters
+ * @param elapsed_us Time since the previous sample
+ */
+static void update_path_throughput(struct netcas_splitter *splitter, uint64_t elapsed_us)
+{
+    uint64_t completed_bytes;
+    uint64_t completed = 0;
+    int path, size, i;
+
+    for (path = 0; path < NETCAS_PATH_MAX; ++path)
     {
-        // Both are at expected ratios, use pattern-based distribution
-        if (pattern_position < pattern_size)
+        splitter->path_throughput[path] = 0;
+
+        for (size = 0; size < NETCAS_SIZE_MAX; ++size)
         {
-            // Pattern-based distribution
-            send_to_backend = (pattern_position >= pattern_cache);
-            pattern_position = (pattern_position + 1) % pattern_size;
+            completed_bytes = 0;
+            for (i = 0; i < splitter->cpus_no; ++i)
+                completed_bytes += env_atomic64_read(&splitter->dispatch[i].completed_bytes[path][size]);
+
+            splitter->size_throughput[path][size] =
+                ((completed_bytes - splitter->last_completed_bytes[path][size]) * 1000000) / elapsed_us;
+            splitter->last_completed_bytes[path][size] = completed_bytes;
+            splitter->path_throughput[path] += splitter->size_throughput[path][size];
         }
+    }
+
+    for (i = 0; i < splitter->cpus_no; ++i)
+        completed += env_atomic64_read(&splitter->dispatch[i].completed);
+
+    splitter->completion_iops = ((completed - splitter->last_completed) * 1000000) / elapsed_us;
+    splitter->last_completed = completed;
+}
+
+/**
+ * @brief Measure share of hit bytes which hit dirty cache lines in the last
+ * sample. Keeps the previous share when there were no hits.
+ */
+static void update_dirty_share(struct netcas_splitter *splitter)
+{
+    uint64_t hit_bytes = 0, dirty_hit_bytes = 0;
+    uint64_t bytes, dirty_bytes;
+    int i;
+
+    for (i = 0; i < splitter->cpus_no; ++i)
+    {
+        hit_bytes += env_atomic64_read(&splitter->dispatch[i].hit_bytes[NETCAS_PATH_CACHE]);
+        hit_bytes += env_atomic64_read(&splitter->dispatch[i].hit_bytes[NETCAS_PATH_BACKEND]);
+        dirty_hit_bytes += env_atomic64_read(&splitter->dispatch[i].dirty_hit_bytes);
+    }
+
+    dirty_bytes = dirty_hit_bytes - splitter->last_dirty_hit_bytes;
+    bytes = hit_bytes - splitter->last_hit_bytes + dirty_bytes;
+    splitter->last_hit_bytes = hit_bytes;
+    splitter->last_dirty_hit_bytes = dirty_hit_bytes;
+
+    if (bytes)
+        splitter->dirty_share = dirty_bytes * SPLIT_RATIO_MAX / bytes;
+}
+
+/**
+ * @brief Track throughput and smoothed completion latency of one target
+ * @param discard Keep latency, used for calibration probe samples
+ */
+static void update_target(struct netcas_splitter *splitter, int set_index, int index,
+                          uint64_t elapsed_us, bool discard)
+{
+    struct netcas_target *target = &splitter->target_sets[set_index].target[index];
+    uint64_t completed_bytes, completions, latency_sum;
+
+    target_read_counters(splitter, set_index, index, &completed_bytes, &completions, &latency_sum);
+
+    target->throughput = ((completed_bytes - target->last_completed_bytes) * 1000000) / elapsed_us;
+    target->last_completed_bytes = completed_bytes;
+    completions -= target->last_completions;
+    target->last_completions += completions;
+    latency_sum -= target->last_latency_sum;
+    target->last_latency_sum += latency_sum;
+    target->sample_completions = completions;
+    target->sample_latency_sum = latency_sum;
+
+    if (discard || completions < TARGET_MIN_COMPLETIONS)
+        return;
+
+    if (target->latency)
+    {
+        target->latency = (target->latency * TARGET_LATENCY_EWMA_OLD_WEIGHT + latency_sum / completions) /
+                          (TARGET_LATENCY_EWMA_OLD_WEIGHT + 1);
+    }
+    else
+    {
+        target->latency = latency_sum / completions;
+    }
+    target->samples++;
+}
+
+/**
+ * @brief Move targets of a set in and out of congestion. Targets serve the
+ * same data over similar paths, so each one is judged against the fastest
+ * one rather than its own history, which moves with the load it gets.
+ * @return true if any target changed congestion state
+ */
+static bool update_target_congestion(struct netcas_target_set *set)
+{
+    struct netcas_target *target;
+    uint64_t reference = 0, increase_permil;
+    bool changed = false;
+    int i;
+
+    for (i = 0; i < set->count; ++i)
+    {
+        target = &set->target[i];
+        if (target->samples < TARGET_WARMUP_SAMPLES)
+            return false;
+        if (!reference || target->latency < reference)
+            reference = target->latency;
+    }
+
+    set->latency_reference = max_t(uint64_t, reference, 1);
+
+    for (i = 0; i < set->count; ++i)
+    {
+        target = &set->target[i];
+        increase_permil = ((target->latency - reference) * 1000) / set->latency_reference;
+
+        if (!target->congested && increase_permil > TARGET_CONGESTION_THRESHOLD)
+            target->congested = true;
+        else if (target->congested && increase_permil < TARGET_RECOVERY_THRESHOLD)
+            target->congested = false;
         else
+            continue;
+
+        NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Core %u target %d %s (latency: %llu ns, fastest: %llu ns)",
+                                  set->core_id, i, target->congested ? "congested" : "recovered",
+                                  target->latency, reference);
+        changed = true;
+    }
+
+    return changed;
+}
+
+/**
+ * @brief Update read targets of all cores, republish their weights and
+ * derive the share of nominal backend bandwidth they deliver, weighted by
+ * how much of the backend throughput each core's targets carry. Also
+ * derive how much faster the healthy targets complete than all of them,
+ * so that mode detection isn't driven by drained targets.
+ * @param discard Don't judge congestion, used for calibration probe samples
+ * @return true if any target changed congestion state
+ */
+static bool update_targets(struct netcas_splitter *splitter, uint64_t elapsed_us, bool discard)
+{
+    struct netcas_target_set *set;
+    struct netcas_target *target;
+    uint64_t backend_throughput = splitter->path_throughput[NETCAS_PATH_BACKEND];
+    uint64_t set_throughput, lost = 0;
+    uint64_t all_completions = 0, all_latency_sum = 0;
+    uint64_t healthy_completions = 0, healthy_latency_sum = 0;
+    uint64_t healthy_latency, all_latency;
+    bool changed = false, drained = false;
+    int i, j;
+
+    for (i = 0; i < TARGET_SETS_MAX; ++i)
+    {
+        set = &splitter->target_sets[i];
+        if (set->count < 2)
+            continue;
+
+        set_throughput = 0;
+        for (j = 0; j < set->count; ++j)
         {
-            // Pattern exhausted, use quota-based distribution
-            if (cache_quota == 0)
-            {
-                send_to_backend = true;
-            }
-            else if (backend_quota == 0)
-            {
-                send_to_backend = false;
-            }
-            else
+            update_target(splitter, i, j, elapsed_us, discard);
+            set_throughput += set->target[j].throughput;
+        }
+
+        if (!discard && update_target_congestion(set))
+        {
+            changed = true;
+            target_set_publish(set);
+        }
+
+        for (j = 0; j < set->count; ++j)
+        {
+            target = &set->target[j];
+            all_completions += target->sample_completions;
+            all_latency_sum += target->sample_latency_sum;
+            if (target->congested)
             {
-                // Both quotas available, alternate to maintain balance
-                send_to_backend = last_request_to_cache;
+                drained = true;
+                continue;
             }
+            healthy_completions += target->sample_completions;
+            healthy_latency_sum += target->sample_latency_sum;
+        }
+
+        if (backend_throughput)
+        {
+            set_throughput = min_t(uint64_t, set_throughput, backend_throughput);
+            lost += (TARGET_CAPACITY_SCALE - set->capacity_permil) * set_throughput / backend_throughput;
         }
     }
 
-    // Update counters and quotas
-    if (send_to_backend)
+    // Without backend traffic there's nothing to weigh capacity by, keep it
+    if (backend_throughput)
+        splitter->target_capacity_permil = TARGET_CAPACITY_SCALE - min_t(uint64_t, lost, TARGET_CAPACITY_SCALE - 1);
+
+    if (!drained)
     {
-        backend_quota--;
-        backend_requests++;
-        last_request_to_cache = false;
-        // NETCAS_SPLITTER_DEBUG_LOG(NULL, "Backend (hit) - split_ratio: %llu.%02llu%%",
-        //                           current_split_ratio / 100, current_split_ratio % 100);
+        splitter->healthy_latency_permil = TARGET_CAPACITY_SCALE;
     }
-    else
+    else if (!discard && healthy_completions && all_latency_sum)
     {
-        cache_quota--;
-        cache_requests++;
-        last_request_to_cache = true;
-        // NETCAS_SPLITTER_DEBUG_LOG(NULL, "Cache (hit) - split_ratio: %llu.%02llu%%",
-        //                           current_split_ratio / 100, current_split_ratio % 100);
+        // Mean latencies first, a product of the sums would overflow
+        healthy_latency = div64_u64(healthy_latency_sum, healthy_completions);
+        all_latency = max_t(uint64_t, div64_u64(all_latency_sum, all_completions), 1);
+        splitter->healthy_latency_permil = min_t(uint64_t, TARGET_CAPACITY_SCALE,
+            div64_u64(healthy_latency * TARGET_CAPACITY_SCALE, all_latency));
     }
 
-    return send_to_backend;
+    return changed;
 }
 
 /**
- * @brief Reset all splitter statistics (useful for testing or reconfiguration)
+ * @brief Histogram bucket of a completion latency
  */
-void netcas_reset_splitter(void)
+static inline uint32_t latency_bucket(uint64_t latency_ns)
 {
-    int i;
+    return min_t(uint32_t, fls64(latency_ns >> LATENCY_HIST_SHIFT), LATENCY_HIST_BUCKETS - 1);
+}
 
-    request_counter = 0;
-    cache_quota = 0;
-    backend_quota = 0;
-    last_request_to_cache = false;
-    pattern_position = 0;
-    pattern_cache = 0;
-    pattern_backend = 0;
-    pattern_size = 0;
-    total_requests = 0;
-    cache_requests = 0;
-    backend_requests = 0;
-
-    // Reset optimal split ratio to default
-    split_set_optimal_ratio(SPLIT_RATIO_MAX);
+/**
+ * @brief Estimate percentile of a latency histogram, interpolating
+ * linearly inside the bucket it falls into
+ * @return Latency in ns, 0 if the histogram is empty
+ */
+static uint64_t latency_hist_percentile(const uint64_t *hist, uint64_t count, uint32_t permil)
+{
+    uint64_t rank = (count * permil + 999) / 1000;
+    uint64_t cumulative = 0;
+    uint64_t lower, upper;
+    uint32_t bucket;
 
-    // Reset mode management variables
-    netCAS_initialized = false;
-    split_ratio_calculated_in_stable = false;
-    current_mode = NETCAS_MODE_IDLE;
+    if (count == 0)
+        return 0;
 
-    // Reset RDMA throughput window
-    for (i = 0; i < RDMA_WINDOW_SIZE; ++i)
-        rdma_throughput_window[i] = 0;
-    rdma_window_sum = 0;
-    rdma_window_index = 0;
-    rdma_window_count = 0;
-    rdma_window_average = 0;
-    max_average_rdma_throughput = 0;
-    last_monitor_update_time = 0;
+    for (bucket = 0; bucket < LATENCY_HIST_BUCKETS; ++bucket)
+    {
+        if (cumulative + hist[bucket] >= rank)
+            break;
+        cumulative += hist[bucket];
+    }
 
-    // Reset RDMA latency window
-    for (i = 0; i < RDMA_WINDOW_SIZE; ++i)
-        rdma_latency_window[i] = 0;
-    rdma_latency_window_sum = 0;
-    rdma_latency_window_index = 0;
-    rdma_latency_window_count = 0;
-    rdma_latency_window_average = 0;
-    min_average_rdma_latency = UINT64_MAX;
-
-    // Reset latency baseline management
-    latency_sample_count = 0;
-    latency_baseline_established = false;
-
-    NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Splitter reset");
-}
\ No newline at end of file
+    if (bucket == LATENCY_HIST_BUCKETS)
+        bucket = LATENCY_HIST_BUCKETS - 1;
+
+    lower = bucket ? 1ULL << (LATENCY_HIST_SHIFT + bucket - 1) : 0;
+    upper = 1ULL << (LATENCY_HIST_SHIFT + bucket);
+
+    return lower + ((upper - lower) * (rank - cumulative)) / hist[bucket];
+}
+
+/**
+ * @brief Move tail bias towards the path whose p99 is within the objective,
+ * and back to zero once both paths meet it
+ */
+static void update_tail_bias(struct netcas_splitter *splitter)
+{
+    uint64_t target = env_atomic64_read(&splitter->p99_target);
+    uint64_t cache_p99 = splitter->path_p99[NETCAS_PATH_CACHE];
+    uint64_t backend_p99 = splitter->path_p99[NETCAS_PATH_BACKEND];
+    int64_t bias = splitter->tail_bias;
+
+    if (target == 0)
+        bias = 0;
+    else if (cache_p99 > target || backend_p99 > target)
+        // Shift load towards the path with the shorter tail
+        bias += cache_p99 > backend_p99 ? -TAIL_BIAS_STEP : TAIL_BIAS_STEP;
+    else if (bias > 0)
+        bias = max_t(int64_t, bias - TAIL_BIAS_STEP / 2, 0);
+    else if (bias < 0)
+        bias = min_t(int64_t, bias + TAIL_BIAS_STEP / 2, 0);
+
+    bias = clamp_t(int64_t, bias, -TAIL_BIAS_MAX, TAIL_BIAS_MAX);
+    if (bias == splitter->tail_bias)
+        return;
+
+    NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Tail bias %lld (p99 cache: %llu ns, backend: %llu ns, target: %llu ns)",
+                              (long long)bias, cache_p99, backend_p99, target);
+
+    splitter->tail_bias = bias;
+    split_publish_ratio(splitter);
+}
+
+/**
+ * @brief Collect per-CPU latency histograms and recompute p99 of each
+ * path once per period
+ * @param elapsed_us Time since the previous sample
+ * @param discard Drop completions since the last collection, used for
+ * calibration probe samples which force all hits to one path
+ */
+static void update_path_latency(struct netcas_splitter *splitter, uint64_t elapsed_us, bool discard)
+{
+    uint64_t hist[LATENCY_HIST_BUCKETS];
+    uint64_t total, count;
+    int path, bucket, i;
+
+    splitter->latency_period_us += elapsed_us;
+    if (!discard && splitter->latency_period_us < LATENCY_P99_PERIOD_US)
+        return;
+
+    splitter->latency_period_us = 0;
+
+    for (path = 0; path < NETCAS_PATH_MAX; ++path)
+    {
+        count = 0;
+        for (bucket = 0; bucket < LATENCY_HIST_BUCKETS; ++bucket)
+        {
+            total = 0;
+            for (i = 0; i < splitter->cpus_no; ++i)
+                total += env_atomic64_read(&splitter->dispatch[i].latency_hist[path][bucket]);
+
+            hist[bucket] = total - splitter->latency_hist_last[path][bucket];
+            splitter->latency_hist_last[path][bucket] = total;
+            count += hist[bucket];
+        }
+
+        if (discard || count < LATENCY_P99_MIN_COMPLETIONS)
+            continue;
+
+        splitter->path_p99[path] = latency_hist_percentile(hist, count, P99_PERMIL);
+        if (splitter->active_params.hedge_budget_permil)
+        {
+            env_atomic64_set(&splitter->hedge_delay[path],
+                             latency_hist_percentile(hist, count, splitter->active_params.hedge_percentile));
+        }
+    }
+
+    if (!discard)
+        update_tail_bias(splitter);
+}
+
+/**
+ * @brief Smooth a parallelism sample, values are kept in 1/16 units
+ */
+static uint64_t parallelism_ewma(uint64_t average, uint64_t sample)
+{
+    sample <<= 4;
+
+    if (average == 0)
+        return sample;
+
+    return (average * PARALLELISM_EWMA_OLD_WEIGHT + sample) / (PARALLELISM_EWMA_OLD_WEIGHT + 1);
+}
+
+/**
+ * @brief Round value to the nearest power of two within 1..max, which are
+ * the keys bandwidth model and static table are populated for
+ */
+static uint64_t parallelism_key(uint64_t value, uint64_t max)
+{
+    uint64_t key = 1;
+
+    while (key < max && value * 2 >= key * 3)
+        key <<= 1;
+
+    return key;
+}
+
+/**
+ * @brief Sample requests in flight and distinct submitters, and derive the
+ * queue depth and job count used as bandwidth model keys. In-flight count
+ * needs completions accounted with netcas_account_completion(), as long as
+ * there are none the default keys are kept.
+ */
+static void update_parallelism(struct netcas_splitter *splitter)
+{
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t submitter_mask = 0;
+    uint64_t inflight;
+    int i;
+
+    for (i = 0; i < splitter->cpus_no; ++i)
+    {
+        // Read completions first so in-flight never goes negative
+        completed += env_atomic64_read(&splitter->dispatch[i].completed);
+        submitted += env_atomic64_read(&splitter->dispatch[i].submitted);
+        submitter_mask |= splitter->dispatch[i].submitter_mask;
+        // Racing with the owner CPU may lose one bit, acceptable for an estimate
+        splitter->dispatch[i].submitter_mask = 0;
+    }
+
+    if (completed == 0)
+    {
+        splitter->io_depth = PARALLELISM_DEFAULT_IO_DEPTH;
+        splitter->numjob = PARALLELISM_DEFAULT_NUMJOB;
+        return;
+    }
+
+    inflight = submitted > completed ? submitted - completed : 0;
+
+    splitter->inflight_average = parallelism_ewma(splitter->inflight_average, inflight);
+    splitter->submitters_average = parallelism_ewma(splitter->submitters_average, hweight64(submitter_mask));
+
+    // Round to nearest, at least one job with one request in flight
+    splitter->numjob = parallelism_key((splitter->submitters_average + 8) >> 4, PARALLELISM_MAX_NUMJOB);
+    splitter->io_depth = parallelism_key(((splitter->inflight_average + 8) >> 4) / splitter->numjob,
+                                         PARALLELISM_MAX_IO_DEPTH);
+}
+
+/**
+ * @brief Feed throughput of each size class delivered by the probed path
+ * into the bandwidth model. Classes without traffic keep their entries.
+ */
+static void calibration_update_model(struct netcas_splitter *splitter, enum netcas_path path,
+                                     uint64_t io_depth, uint64_t numjob)
+{
+    uint64_t throughput;
+    int size;
+
+    for (size = 0; size < NETCAS_SIZE_MAX; ++size)
+    {
+        // Model holds backend bandwidth with all read targets healthy
+        throughput = splitter->size_throughput[path][size];
+        if (path == NETCAS_PATH_BACKEND)
+            throughput = throughput * TARGET_CAPACITY_SCALE / splitter->target_capacity_permil;
+
+        netcas_bw_model_update(&splitter->bw_model, path, size, io_depth, numjob, throughput);
+    }
+}
+
+/**
+ * @brief Run online calibration. Periodically forces all hits to the cache
+ * and then to the backend for a short probe, and feeds the throughput
+ * delivered by the probed path into the bandwidth model.
+ * @param elapsed_us Time since the previous sample
+ * @return true if the last sample was taken during a probe
+ */
+static bool calibration_step(struct netcas_splitter *splitter, uint64_t io_depth, uint64_t numjob,
+                             uint64_t elapsed_us)
+{
+    switch (splitter->calibration_state)
+    {
+    case CALIBRATION_IDLE:
+        // Probes learn only from accounted completions, without them
+        // they would just perturb live traffic
+        if (splitter->path_throughput[NETCAS_PATH_CACHE] || splitter->path_throughput[NETCAS_PATH_BACKEND])
+            splitter->calibration_fed = true;
+        if (!splitter->online_calibration)
+            return false;
+        if (splitter->active_params.pinned_ratio != NETCAS_RATIO_UNPINNED)
+            return false;
+        if (splitter->current_mode != NETCAS_MODE_WARMUP && splitter->current_mode != NETCAS_MODE_STABLE)
+            return false;
+        // Model holds backend with all read targets healthy, drained ones would skew it
+        if (splitter->healthy_latency_permil < TARGET_CAPACITY_SCALE)
+            return false;
+        splitter->calibration_idle_us += elapsed_us;
+        if (splitter->calibration_idle_us < CALIBRATION_PERIOD_US || !splitter->calibration_fed)
+            return false;
+
+        splitter->calibration_state = CALIBRATION_PROBE_CACHE;
+        splitter->calibration_idle_us = 0;
+        splitter->calibration_fed = false;
+        splitter->calibration_samples = 0;
+        split_publish_forced_ratio(splitter, SPLIT_RATIO_MAX);
+        return false;
+
+    case CALIBRATION_PROBE_CACHE:
+        if (++splitter->calibration_samples < CALIBRATION_PROBE_SAMPLES)
+            return true;
+
+        calibration_update_model(splitter, NETCAS_PATH_CACHE, io_depth, numjob);
+        splitter->calibration_state = CALIBRATION_PROBE_BACKEND;
+        splitter->calibration_samples = 0;
+        split_publish_forced_ratio(splitter, SPLIT_RATIO_MIN);
+        return true;
+
+    case CALIBRATION_PROBE_BACKEND:
+        if (++splitter->calibration_samples < CALIBRATION_PROBE_SAMPLES)
+            return true;
+
+        calibration_update_model(splitter, NETCAS_PATH_BACKEND, io_depth, numjob);
+        splitter->calibration_state = CALIBRATION_IDLE;
+        splitter->calibration_samples = 0;
+        split_publish_ratio(splitter);
+        // Next sample still carries the probe, don't let it score
+        splitter->hill_climb.settle = HILL_CLIMB_SETTLE_SAMPLES;
+        // Stable mode recomputes the split from the refreshed model
+        splitter->split_ratio_calculated_in_stable = false;
+
+        NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Calibrated - Cache: %llu B/s, Backend: %llu B/s",
+                                  splitter->path_throughput[NETCAS_PATH_CACHE],
+                                  splitter->path_throughput[NETCAS_PATH_BACKEND]);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Calculate split ratio using the formula A/(A+B) * 10000.
+ * This is the core formula for determining optimal split ratio.
+ * Uses 0-10000 scale where 10000 = 100% for more accurate calculations.
+ * @param fallback Ratio returned when neither path has known bandwidth
+ */
+static uint64_t calculate_split_ratio_formula(uint64_t bandwidth_cache_only, uint64_t bandwidth_backend_only,
+                                              uint64_t fallback)
+{
+    uint64_t calculated_split;
+
+    if (bandwidth_cache_only + bandwidth_backend_only == 0)
+        return fallback;
+
+    /* Calculate optimal split ratio using formula A/(A+B) * 10000 */
+    calculated_split = (bandwidth_cache_only * SPLIT_RATIO_SCALE) / (bandwidth_cache_only + bandwidth_backend_only);
+
+    /* Ensure the result is within valid range (0-10000) */
+    if (calculated_split < SPLIT_RATIO_MIN)
+        calculated_split = SPLIT_RATIO_MIN;
+    if (calculated_split > SPLIT_RATIO_MAX)
+        calculated_split = SPLIT_RATIO_MAX;
+
+    return calculated_split;
+}
+
+/**
+ * @brief Function to find the best split ratio for given IO depth and NumJob.
+ * Based on the algorithm from netCAS_split.c, applied to every request size
+ * class. The per class results are stored as offsets from the returned
+ * ratio, which is their average weighted by bytes recently read in each class.
+ * Returns split ratio in 0-10000 scale where 10000 = 100%.
+ */
+static uint64_t find_best_split_ratio(struct netcas_splitter *splitter, uint64_t io_depth, uint64_t numjob,
+                                      uint64_t drop_permil)
+{
+    uint64_t bandwidth_cache_only;   /* A: bandwidth when split ratio is 100% (all to cache) */
+    uint64_t bandwidth_backend_only; /* B: bandwidth when split ratio is 0% (all to backend) */
+    uint64_t size_split[NETCAS_SIZE_MAX];
+    uint64_t weight, weight_sum = 0, weighted_split = 0;
+    uint64_t calculated_split;       /* Calculated optimal split ratio */
+    uint64_t fallback;
+    int64_t offset;
+    bool offsets_changed = false;
+    int size;
+
+    for (size = 0; size < NETCAS_SIZE_MAX; ++size)
+    {
+        /* Get A and B from the calibrated model, or the static table if not calibrated yet */
+        netcas_bw_model_lookup(&splitter->bw_model, size, io_depth, numjob,
+                               &bandwidth_cache_only, &bandwidth_backend_only);
+
+        // Backend is the sum of read targets, drained ones deliver less of it
+        bandwidth_backend_only = bandwidth_backend_only * splitter->target_capacity_permil /
+                                 TARGET_CAPACITY_SCALE;
+
+        // Apply bandwidth drop to backend bandwidth if there's congestion
+        if (splitter->latency_congested)
+        {
+            bandwidth_backend_only = (uint64_t)((bandwidth_backend_only * (1000 - drop_permil)) / 1000);
+        }
+
+        /* Calculate optimal split ratio of the class using the formula */
+        fallback = clamp_t(int64_t, (int64_t)splitter->optimal_split_ratio + splitter->size_offset[size],
+                           SPLIT_RATIO_MIN, SPLIT_RATIO_MAX);
+        size_split[size] = calculate_split_ratio_formula(bandwidth_cache_only, bandwidth_backend_only,
+                                                         fallback);
+
+        // Classes without recent traffic still count, so idle workload gets a plain average
+        weight = splitter->size_throughput[NETCAS_PATH_CACHE][size] +
+                 splitter->size_throughput[NETCAS_PATH_BACKEND][size] + 1;
+        weighted_split += size_split[size] * weight;
+        weight_sum += weight;
+
+        // Log the calculation for debugging
+        NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Split ratio calculation - Size class: %d, Cache BW: %llu, Backend BW: %llu, Drop: %llu%%, Result: %llu.%02llu%%",
+                                  size, bandwidth_cache_only, bandwidth_backend_only, drop_permil / 10,
+                                  size_split[size] / 100, size_split[size] % 100);
+    }
+
+    calculated_split = weighted_split / weight_sum;
+
+    for (size = 0; size < NETCAS_SIZE_MAX; ++size)
+    {
+        offset = (int64_t)size_split[size] - (int64_t)calculated_split;
+        if (offset != splitter->size_offset[size])
+        {
+            splitter->size_offset[size] = offset;
+            offsets_changed = true;
+        }
+    }
+
+    // Callers publish only when the ratio itself moves
+    if (offsets_changed)
+        split_publish_ratio(splitter);
+
+    return calculated_split;
+}
+
+/**
+ * @brief Move optimal ratio by the current step, bouncing off range ends
+ */
+static void hill_climb_move(struct netcas_splitter *splitter)
+{
+    struct netcas_hill_climb *hc = &splitter->hill_climb;
+    int64_t ratio = splitter->optimal_split_ratio + hc->direction * (int64_t)hc->step;
+
+    if (ratio > SPLIT_RATIO_MAX || ratio < SPLIT_RATIO_MIN)
+    {
+        hc->direction = -hc->direction;
+        ratio = splitter->optimal_split_ratio + hc->direction * (int64_t)hc->step;
+    }
+
+    if (ratio > SPLIT_RATIO_MAX)
+        ratio = SPLIT_RATIO_MAX;
+    if (ratio < SPLIT_RATIO_MIN)
+        ratio = SPLIT_RATIO_MIN;
+
+    split_set_optimal_ratio(splitter, ratio);
+    hc->settle = HILL_CLIMB_SETTLE_SAMPLES;
+}
+
+/**
+ * @brief Closed-loop split ratio search. Scores the current ratio by the
+ * IOPS delivered by completions, keeps moving while the score improves
+ * beyond the guard band and turns around with half the step when it gets
+ * worse. Changes within the guard band decay the step until it reaches
+ * the minimum, then the ratio is held until the score moves again.
+ */
+static void hill_climb_run(struct netcas_splitter *splitter)
+{
+    struct netcas_hill_climb *hc = &splitter->hill_climb;
+    uint64_t score;
+
+    // Workload changed class, search again with a coarse step
+    if (hc->mode != splitter->current_mode)
+        hill_climb_reset(splitter);
+
+    if (hc->settle > 0)
+    {
+        hc->settle--;
+        return;
+    }
+
+    hc->score_sum += splitter->completion_iops;
+    if (++hc->score_samples < HILL_CLIMB_MEASURE_SAMPLES)
+        return;
+
+    score = hc->score_sum / hc->score_samples;
+    hc->score_sum = 0;
+    hc->score_samples = 0;
+
+    // Search moves all size classes together, their offsets follow the model
+    find_best_split_ratio(splitter, splitter->io_depth, splitter->numjob, 0);
+
+    if (hc->prev_score == 0)
+    {
+        // First score at the starting point, nothing to compare yet
+    }
+    else if (score * 1000 > hc->prev_score * (1000 + HILL_CLIMB_GUARD_BAND))
+    {
+        // Better, keep going in the same direction
+    }
+    else if (score * 1000 < hc->prev_score * (1000 - HILL_CLIMB_GUARD_BAND))
+    {
+        // Worse, turn around with a finer step
+        hc->direction = -hc->direction;
+        hc->step = max_t(uint64_t, hc->step / 2, HILL_CLIMB_STEP_MIN);
+    }
+    else if (hc->step == HILL_CLIMB_STEP_MIN)
+    {
+        // Converged, hold the ratio
+        hc->prev_score = score;
+        return;
+    }
+    else
+    {
+        hc->step = max_t(uint64_t, hc->step / 2, HILL_CLIMB_STEP_MIN);
+    }
+
+    hc->prev_score = score;
+    hill_climb_move(splitter);
+
+    NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Hill climb - Score: %llu IOPS, Step: %llu, Split ratio: %llu.%02llu%%",
+                              score, hc->step, splitter->optimal_split_ratio / 100,
+                              splitter->optimal_split_ratio % 100);
+}
+
+/**
+ * @brief Apply policy requested with netcas_set_policy()
+ */
+static void apply_policy(struct netcas_splitter *splitter)
+{
+    enum netcas_policy policy = env_atomic_read(&splitter->requested_policy);
+
+    if (policy == splitter->policy)
+        return;
+
+    NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Policy changed from %d to %d", splitter->policy, policy);
+
+    splitter->policy = policy;
+    // Either controller starts over from the ratio the other one left
+    hill_climb_reset(splitter);
+    splitter->split_ratio_calculated_in_stable = false;
+}
+
+/**
+ * @brief Determine the current netCAS mode based on performance metrics
+ */
+static netCAS_mode_t determine_netcas_mode(struct netcas_splitter *splitter, uint64_t curr_rdma_throughput, uint64_t curr_rdma_latency,
+                                           uint64_t curr_iops, uint64_t bw_drop_permil, uint64_t latency_increase_permil)
+{
+    netCAS_mode_t previous_mode = splitter->current_mode;
+
+    // No Active RDMA traffic or no IOPS, set netCAS_mode to IDLE
+    if (curr_rdma_throughput <= RDMA_THRESHOLD && curr_iops <= IOPS_THRESHOLD)
+    {
+        splitter->current_mode = NETCAS_MODE_IDLE;
+    }
+    // Active RDMA traffic, determine the mode
+    else
+    {
+        // First time active RDMA traffic, set netCAS_mode to WARMUP
+        if (splitter->current_mode == NETCAS_MODE_IDLE)
+        {
+            // Idle -> Warmup
+            NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Mode changed from IDLE to WARMUP");
+            splitter->current_mode = NETCAS_MODE_WARMUP;
+            splitter->netCAS_initialized = false;
+        }
+        else if (splitter->current_mode == NETCAS_MODE_WARMUP)
+        {
+            // Warmup -> Stable
+            if (splitter->rdma_window_count >= RDMA_WINDOW_SIZE)
+            {
+                NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Mode changed from WARMUP to STABLE (window full)");
+                splitter->current_mode = NETCAS_MODE_STABLE;
+                splitter->split_ratio_calculated_in_stable = false; // Reset flag when entering stable mode
+            }
+            else
+            {
+                // Still in warmup, do nothing
+            }
+        }
+        else if (splitter->current_mode == NETCAS_MODE_CONGESTION && !splitter->latency_congested)
+        {
+            // Congestion -> Stable, latency back within noise of the baseline
+            NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Mode changed from CONGESTION to STABLE (BW_Drop: %llu%%, Lat_Drop: %llu%%)",
+                                      bw_drop_permil / 10, latency_increase_permil / 10);
+            splitter->current_mode = NETCAS_MODE_STABLE;
+            splitter->split_ratio_calculated_in_stable = false; // Reset flag when entering stable mode
+        }
+        else if (splitter->current_mode == NETCAS_MODE_STABLE && splitter->latency_congested)
+        {
+            // Stable -> Congestion, latency held clearly above its noise
+            NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Mode changed from STABLE to CONGESTION (BW_Drop: %llu%%, Lat_Drop: %llu%%)",
+                                      bw_drop_permil / 10, latency_increase_permil / 10);
+            splitter->current_mode = NETCAS_MODE_CONGESTION;
+            splitter->split_ratio_calculated_in_stable = true; // Set flag when entering congestion
+        }
+        else if (CACHING_FAILED)
+        {
+            NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Mode changed to FAILURE");
+            splitter->current_mode = NETCAS_MODE_FAILURE;
+        }
+    }
+
+    // Log mode changes
+    if (previous_mode != splitter->current_mode)
+    {
+        NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Mode changed from %d to %d (RDMA: %llu, IOPS: %llu, BW_Drop: %llu%%, Lat_Drop: %llu%%)",
+                                  previous_mode, splitter->current_mode, curr_rdma_throughput, curr_iops,
+                                  bw_drop_permil / 10, latency_increase_permil / 10);
+    }
+
+    return splitter->current_mode;
+}
+
+/**
+ * @brief Make tunables set with netcas_set_params() active
+ */
+static void apply_params(struct netcas_splitter *splitter)
+{
+    struct netcas_params params;
+
+    env_spinlock_lock(&splitter->lock);
+    params = splitter->params;
+    env_spinlock_unlock(&splitter->lock);
+
+    if (params.pinned_ratio != splitter->active_params.pinned_ratio)
+    {
+        NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Pinned ratio changed from %u to %u",
+                                  splitter->active_params.pinned_ratio, params.pinned_ratio);
+
+        // Once unpinned, controllers start over from the pinned ratio
+        hill_climb_reset(splitter);
+        splitter->split_ratio_calculated_in_stable = false;
+    }
+
+    if (!params.hedge_budget_permil)
+    {
+        env_atomic64_set(&splitter->hedge_delay[NETCAS_PATH_CACHE], 0);
+        env_atomic64_set(&splitter->hedge_delay[NETCAS_PATH_BACKEND], 0);
+    }
+    env_atomic_set(&splitter->hedge_budget, params.hedge_budget_permil);
+
+    splitter->active_params = params;
+}
+
+/**
+ * @brief Make read targets set with netcas_set_targets() active
+ */
+static void apply_targets(struct netcas_splitter *splitter)
+{
+    struct netcas_target_set *set;
+    int i, j;
+
+    for (i = 0; i < TARGET_SETS_MAX; ++i)
+    {
+        set = &splitter->target_sets[i];
+
+        env_spinlock_lock(&splitter->lock);
+        if (!set->changed)
+        {
+            env_spinlock_unlock(&splitter->lock);
+            continue;
+        }
+        set->changed = false;
+        set->count = set->requested_count;
+        for (j = 0; j < set->count; ++j)
+            set->target[j].bandwidth = set->requested_bandwidth[j];
+        env_spinlock_unlock(&splitter->lock);
+
+        NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Core %u read targets: %u", set->core_id, set->count);
+
+        target_set_reset(splitter, i);
+        splitter->split_ratio_calculated_in_stable = false;
+    }
+}
+
+/**
+ * @brief Set how much the backend may take while congested. Lowering the
+ * share of hits leaves misses and writes at full rate, so submitters hold
+ * all backend traffic to this budget. It starts at the throughput the link
+ * delivers, shrinks while latency keeps rising, holds while latency stays
+ * up but flat, as added delay the load has no part in doesn't go away by
+ * sending less, and grows back once latency is down. It stays between a
+ * floor and the peak. Out of congestion the backend is unthrottled.
+ */
+static void update_backend_budget(struct netcas_splitter *splitter, uint64_t curr_rdma_throughput)
+{
+    uint64_t peak = splitter->max_average_rdma_throughput * BUDGET_BYTES_PER_MIB;
+    uint64_t budget = env_atomic64_read(&splitter->backend_budget);
+    uint64_t latency = splitter->latency_mean;
+
+    if (splitter->current_mode != NETCAS_MODE_CONGESTION || !peak)
+    {
+        budget = 0;
+    }
+    else if (!budget)
+    {
+        budget = curr_rdma_throughput * BUDGET_BYTES_PER_MIB;
+        splitter->budget_latency = latency;
+    }
+    else if (splitter->latency_increase_permil <= splitter->active_params.latency_recovery_threshold)
+    {
+        budget += peak * BUDGET_INCREASE_PERMIL / 1000;
+        splitter->budget_latency = latency;
+    }
+    else if (latency * 1000 > splitter->budget_latency * (1000 + BUDGET_RISE_PERMIL))
+    {
+        budget = budget * BUDGET_DECREASE_PERMIL / 1000;
+        splitter->budget_latency = latency;
+    }
+    else
+    {
+        // Falling latency is the new reference, so a later rise shows
+        splitter->budget_latency = min_t(uint64_t, splitter->budget_latency, latency);
+    }
+
+    if (budget)
+        budget = clamp_t(uint64_t, budget, peak * BUDGET_FLOOR_PERMIL / 1000, peak);
+
+    NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Backend budget: %llu B/s", budget);
+    env_atomic64_set(&splitter->backend_budget, budget);
+}
+
+/**
+ * @brief Publish state for netcas_get_telemetry()
+ */
+static void update_telemetry(struct netcas_splitter *splitter)
+{
+    struct netcas_telemetry telemetry;
+    int size, path, set, i;
+
+    telemetry.mode = splitter->current_mode;
+    telemetry.policy = splitter->policy;
+    telemetry.optimal_ratio = splitter->optimal_split_ratio;
+    for (size = 0; size < NETCAS_SIZE_MAX; ++size)
+        telemetry.published_ratio[size] = env_atomic64_read(&splitter->published_split_ratio[size]);
+    telemetry.achieved_ratio = 0; // Filled in on read
+    telemetry.dirty_hit_ratio = 0; // Filled in on read
+    telemetry.rdma_throughput_average = splitter->rdma_window_average;
+    telemetry.max_rdma_throughput_average = splitter->max_average_rdma_throughput;
+    telemetry.rdma_latency_average = splitter->rdma_latency_window_average;
+    telemetry.min_rdma_latency_average = splitter->latency_baseline_established ?
+                                         splitter->latency_baseline : 0;
+    telemetry.bw_drop_permil = splitter->bw_drop_permil;
+    telemetry.latency_increase_permil = splitter->latency_increase_permil;
+    for (path = 0; path < NETCAS_PATH_MAX; ++path)
+    {
+        telemetry.path_throughput[path] = splitter->path_throughput[path];
+        telemetry.path_p99[path] = splitter->path_p99[path];
+        telemetry.hedge_delay[path] = env_atomic64_read(&splitter->hedge_delay[path]);
+    }
+    telemetry.io_depth = splitter->io_depth;
+    telemetry.numjob = splitter->numjob;
+    telemetry.tail_bias = splitter->tail_bias;
+    telemetry.backend_budget = env_atomic64_read(&splitter->backend_budget);
+
+    env_spinlock_lock(&splitter->lock);
+    splitter->telemetry = telemetry;
+    for (set = 0; set < TARGET_SETS_MAX; ++set)
+    {
+        for (i = 0; i < splitter->target_sets[set].count; ++i)
+        {
+            struct netcas_target *target = &splitter->target_sets[set].target[i];
+            struct netcas_target_stats *stats = &splitter->target_sets[set].stats[i];
+
+            stats->bandwidth = target->bandwidth;
+            stats->weight = env_atomic_read(&splitter->target_sets[set].weight[i]);
+            stats->throughput = target->throughput;
+            stats->latency = target->latency;
+            stats->latency_reference = splitter->target_sets[set].latency_reference;
+            stats->congested = target->congested;
+        }
+    }
+    env_spinlock_unlock(&splitter->lock);
+}
+
+/**
+ * @brief Sample the monitor and update the optimal split ratio.
+ */
+static void monitor_step(struct netcas_splitter *splitter)
+{
+    uint64_t new_split_ratio;
+    uint64_t curr_rdma_throughput = 0;
+    uint64_t curr_rdma_latency = 0;
+    uint64_t curr_iops = 0;
+    uint64_t now_ns = env_get_monotonic_ns();
+    uint64_t elapsed_us;
+    uint64_t bw_drop_permil = 0;
+    uint64_t expected_rdma_throughput, backend_share;
+    uint64_t latency_increase_permil = 0;
+    struct performance_metrics metrics;
+    netCAS_mode_t netCAS_mode;
+    uint64_t current_time = now_ns / 1000000;
+
+    /*
+     * Monitor thread wakes up late and by varying amounts, so rates are
+     * taken over the time which really elapsed. The first sample after
+     * start or reset has nothing to measure from and assumes the interval.
+     */
+    if (splitter->last_sample_ns && now_ns > splitter->last_sample_ns)
+        elapsed_us = max_t(uint64_t, (now_ns - splitter->last_sample_ns) / 1000, 1);
+    else
+        elapsed_us = (uint64_t)splitter->active_params.monitor_interval_ms * 1000;
+    splitter->last_sample_ns = now_ns;
+
+    // Time since the last sample was spent in the mode it left
+    env_atomic64_add(elapsed_us, &splitter->mode_time_us[splitter->current_mode]);
+
+    // Measure current performance metrics using netCAS_monitor, which counts in ms
+    metrics = measure_performance(max_t(uint64_t, (elapsed_us + 500) / 1000, 1));
+    curr_rdma_throughput = metrics.rdma_throughput;
+    curr_rdma_latency = metrics.rdma_latency;
+    curr_iops = metrics.iops;
+
+    update_path_throughput(splitter, elapsed_us);
+    update_dirty_share(splitter);
+    update_parallelism(splitter);
+    apply_policy(splitter);
+
+    // Probe samples measure a forced split, keep them out of the detector windows
+    if (calibration_step(splitter, splitter->io_depth, splitter->numjob, elapsed_us))
+    {
+        update_targets(splitter, elapsed_us, true);
+        update_path_latency(splitter, elapsed_us, true);
+        trace_sample(splitter, curr_rdma_throughput, curr_rdma_latency, curr_iops);
+        return;
+    }
+
+    update_path_latency(splitter, elapsed_us, false);
+
+    // Read target drained or back, stable mode has to recompute the split
+    // and the next probe waits for the target set to settle
+    if (update_targets(splitter, elapsed_us, false))
+    {
+        splitter->split_ratio_calculated_in_stable = false;
+        splitter->calibration_idle_us = 0;
+    }
+
+    // Drained read targets are dealt with by their weights, the mode
+    // follows latency of the healthy ones
+    curr_rdma_latency = curr_rdma_latency * splitter->healthy_latency_permil / TARGET_CAPACITY_SCALE;
+
+    // Update RDMA throughput window for moving average calculation. Window
+    // holds throughput with all read targets healthy, so that the drop
+    // measures congestion only and doesn't lag when drained targets return.
+    update_rdma_window(splitter, curr_rdma_throughput * TARGET_CAPACITY_SCALE / splitter->target_capacity_permil);
+    // Update RDMA latency window for moving average calculation
+    update_rdma_latency_window(splitter, curr_rdma_latency);
+
+    // Calculate drop percentage if we have enough data. Backend given a
+    // smaller share than at its peak delivers less without losing anything.
+    if (splitter->max_average_rdma_throughput > 0)
+    {
+        expected_rdma_throughput = splitter->max_average_rdma_throughput;
+        backend_share = SPLIT_RATIO_MAX - splitter->optimal_split_ratio;
+        if (backend_share < splitter->max_rdma_backend_share)
+            expected_rdma_throughput = expected_rdma_throughput * backend_share / splitter->max_rdma_backend_share;
+        if (expected_rdma_throughput > splitter->rdma_window_average)
+            bw_drop_permil = ((expected_rdma_throughput - splitter->rdma_window_average) * 1000) /
+                             expected_rdma_throughput;
+    }
+
+    splitter->bw_drop_permil = bw_drop_permil;
+
+    // Feed the congestion detector, which sets latency_increase_permil
+    update_latency_baseline(splitter, curr_rdma_latency, bw_drop_permil, elapsed_us);
+    update_latency_congestion(splitter, bw_drop_permil, elapsed_us);
+    latency_increase_permil = splitter->latency_increase_permil;
+
+    // Determine current mode based on performance metrics
+    netCAS_mode = determine_netcas_mode(splitter, curr_rdma_throughput, curr_rdma_latency, curr_iops,
+                                        bw_drop_permil, latency_increase_permil);
+
+    if (splitter->active_params.pinned_ratio != NETCAS_RATIO_UNPINNED)
+    {
+        // Ratio pinned by the operator, controllers stay out
+        if (splitter->optimal_split_ratio != splitter->active_params.pinned_ratio)
+            split_set_optimal_ratio(splitter, splitter->active_params.pinned_ratio);
+    }
+    // Hill climbing searches in all active modes, formula policy below
+    else if (splitter->policy == NETCAS_POLICY_HILL_CLIMB &&
+        netCAS_mode != NETCAS_MODE_IDLE && netCAS_mode != NETCAS_MODE_FAILURE)
+    {
+        hill_climb_run(splitter);
+    }
+    else
+    {
+        // Update split ratio based on mode
+        switch (netCAS_mode)
+        {
+        case NETCAS_MODE_IDLE:
+            if (!splitter->netCAS_initialized)
+            {
+                // Initialize with default values
+                split_set_optimal_ratio(splitter, SPLIT_RATIO_MAX);
+                splitter->netCAS_initialized = true;
+                NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: IDLE mode - initialized with default split ratio");
+            }
+            break;
+
+        case NETCAS_MODE_WARMUP:
+            // In warmup mode, calculate split ratio without drop (assuming no contention in startup)
+            new_split_ratio = find_best_split_ratio(splitter, splitter->io_depth, splitter->numjob, 0);
+            if (new_split_ratio != splitter->optimal_split_ratio)
+            {
+                split_set_optimal_ratio(splitter, new_split_ratio);
+                NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: WARMUP mode - Updated split ratio to: %llu.%02llu%% (RDMA: %llu, IOPS: %llu)",
+                                          new_split_ratio / 100, new_split_ratio % 100, curr_rdma_throughput, curr_iops);
+            }
+            break;
+
+        case NETCAS_MODE_STABLE:
+            // Only calculate split ratio once in stable mode
+            if (!splitter->split_ratio_calculated_in_stable && splitter->rdma_window_count >= RDMA_WINDOW_SIZE)
+            {
+                new_split_ratio = find_best_split_ratio(splitter, splitter->io_depth, splitter->numjob, bw_drop_permil);
+                split_set_optimal_ratio(splitter, new_split_ratio);
+                splitter->split_ratio_calculated_in_stable = true; // Mark as calculated
+                NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: STABLE mode - Calculated split ratio: %llu.%02llu%% (RDMA: %llu, IOPS: %llu, Drop: %llu%%)",
+                                          new_split_ratio / 100, new_split_ratio % 100, curr_rdma_throughput, curr_iops, bw_drop_permil / 10);
+            }
+            break;
+
+        case NETCAS_MODE_CONGESTION:
+            // Continuously calculate split ratio in congestion mode
+            if (splitter->rdma_window_count >= RDMA_WINDOW_SIZE)
+            {
+                new_split_ratio = find_best_split_ratio(splitter, splitter->io_depth, splitter->numjob, bw_drop_permil);
+
+                // Update the split ratio if it changed
+                if (new_split_ratio != splitter->optimal_split_ratio)
+                {
+                    split_set_optimal_ratio(splitter, new_split_ratio);
+                    NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: CONGESTION mode - Updated split ratio to: %llu.%02llu%% (RDMA: %llu, IOPS: %llu, Drop: %llu%%)",
+                                              new_split_ratio / 100, new_split_ratio % 100, curr_rdma_throughput, curr_iops, bw_drop_permil / 10);
+                }
+            }
+            break;
+
+        case NETCAS_MODE_FAILURE:
+            // In failure mode, keep current ratio or set to safe default
+            NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: FAILURE mode - Keeping current split ratio: %llu.%02llu%% (RDMA: %llu, IOPS: %llu)",
+                                      splitter->optimal_split_ratio / 100, splitter->optimal_split_ratio % 100,
+                                      curr_rdma_throughput, curr_iops);
+            break;
+        }
+    }
+
+    update_backend_budget(splitter, curr_rdma_throughput);
+
+    trace_sample(splitter, curr_rdma_throughput, curr_rdma_latency, curr_iops);
+
+    if (splitter->active_params.log_interval_ms &&
+        current_time - splitter->last_logged_time >= splitter->active_params.log_interval_ms)
+    {
+        printk(KERN_INFO "netCAS: %s: Current metrics - RDMA: %llu, RDMA_Lat: %llu (baseline: %llu), IOPS: %llu, BW_Drop: %llu%%, Lat_Inc: %llu%%, Mode: %d, Policy: %d, p99 cache/backend: %llu/%llu ns, Bias: %lld, QD: %llu, Jobs: %llu, Split Ratio: %llu.%02llu%%\n",
+               ocf_cache_get_name(splitter->cache), curr_rdma_throughput, splitter->rdma_latency_window_average,
+               splitter->latency_baseline, curr_iops, bw_drop_permil / 10, latency_increase_permil / 10,
+               splitter->current_mode, splitter->policy,
+               splitter->path_p99[NETCAS_PATH_CACHE], splitter->path_p99[NETCAS_PATH_BACKEND],
+               (long long)splitter->tail_bias, splitter->io_depth, splitter->numjob,
+               (unsigned long long)splitter->optimal_split_ratio / 100,
+               (unsigned long long)splitter->optimal_split_ratio % 100);
+        splitter->last_logged_time = current_time;
+    }
+}
+
+/**
+ * @brief Run one monitor step.
+ * Runs in the per-cache monitor thread, never on the I/O submission path.
+ * @return Time in ms after which the monitor should run again
+ */
+uint32_t netcas_monitor_run(struct netcas_splitter *splitter)
+{
+    apply_params(splitter);
+    apply_targets(splitter);
+
+    if (env_atomic_cmpxchg(&splitter->reset_requested, 1, 0) == 1)
+    {
+        splitter_reset_state(splitter);
+        NETCAS_SPLITTER_DEBUG_LOG(NULL, "netCAS: Splitter reset");
+    }
+
+    monitor_step(splitter);
+    update_telemetry(splitter);
+
+    return splitter->active_params.monitor_interval_ms;
+}
+
+/**
+ * @brief Size class of a request
+ */
+static inline enum netcas_size_class netcas_size_class(uint32_t bytes)
+{
+    if (bytes <= SIZE_SMALL_MAX_BYTES)
+        return NETCAS_SIZE_SMALL;
+    if (bytes <= SIZE_MEDIUM_MAX_BYTES)
+        return NETCAS_SIZE_MEDIUM;
+    return NETCAS_SIZE_LARGE;
+}
+
+/**
+ * @brief Pick the path for a hit using this CPU's pattern of the hit's size
+ * class. Deficits are measured in bytes.
+ */
+static bool dispatch_hit(struct netcas_dispatch *dispatch, struct netcas_split_pattern *pattern,
+                         uint32_t bytes)
+{
+    bool send_to_backend;
+
+    pattern->cache_deficit += (int64_t)bytes * pattern->split_ratio;
+
+    // Midpoint rule, cache only if it's owed at least half of this request
+    send_to_backend = 2 * pattern->cache_deficit < (int64_t)bytes * SPLIT_RATIO_MAX;
+
+    if (send_to_backend)
+    {
+        env_atomic64_inc(&dispatch->backend_hits);
+        env_atomic64_add(bytes, &dispatch->hit_bytes[NETCAS_PATH_BACKEND]);
+    }
+    else
+    {
+        pattern->cache_deficit -= (int64_t)bytes * SPLIT_RATIO_MAX;
+        env_atomic64_inc(&dispatch->cache_hits);
+        env_atomic64_add(bytes, &dispatch->hit_bytes[NETCAS_PATH_CACHE]);
+    }
+
+    return send_to_backend;
+}
+
+/**
+ * @brief Statistics counters of the core of a request on given CPU. The
+ * first request of a core takes a slot; racing CPUs may each take one, the
+ * one stored first is used and the others stay unused.
+ */
+static struct netcas_core_counters *core_counters_get(struct netcas_splitter *splitter,
+                                                      struct netcas_dispatch *dispatch,
+                                                      ocf_core_id_t core_id)
+{
+    int slot = env_atomic_read(&splitter->core_stats_slot[core_id]);
+    int new_slot;
+
+    if (!slot)
+    {
+        new_slot = env_atomic_inc_return(&splitter->core_stats_slots_used);
+        if (new_slot > CORE_STATS_SLOTS)
+            new_slot = CORE_STATS_SHARED;
+        slot = env_atomic_cmpxchg(&splitter->core_stats_slot[core_id], 0, new_slot);
+        if (!slot)
+            slot = new_slot;
+    }
+
+    if (slot == CORE_STATS_SHARED)
+        return &splitter->core_counters[core_id];
+
+    return &dispatch->cores[slot - 1];
+}
+
+/**
+ * @brief Decide whether to send request to cache or backend. Hits are
+ * split by the pattern of their size class, with the ratio published for it.
+ * @param req The OCF request
+ * @return true if request should go to backend, false for cache
+ */
+bool netcas_should_send_to_backend(struct ocf_request *req)
+{
+    struct netcas_splitter *splitter = env_netcas_get_splitter(req->cache);
+    struct netcas_core_counters *counters;
+    struct netcas_dispatch *dispatch;
+    struct netcas_split_pattern *pattern;
+    enum netcas_size_class size;
+    enum netcas_path path;
+    ocf_part_id_t part_id;
+    uint64_t split_ratio;
+    uint32_t hedge_budget;
+    int bounds;
+    bool send_to_backend;
+    unsigned cpu;
+
+    // No splitter attached to this cache - serve every hit from cache
+    if (!splitter)
+        return ocf_engine_is_miss(req);
+
+    size = netcas_size_class(req->byte_length);
+    part_id = req->part_id < OCF_USER_IO_CLASS_MAX ? req->part_id : 0;
+
+    cpu = env_get_execution_context();
+    dispatch = &splitter->dispatch[cpu];
+    dispatch_sync(splitter, dispatch);
+    pattern = &dispatch->pattern[part_id][size];
+
+    // Take a new ratio snapshot at window start
+    if (pattern->request_counter % WINDOW_SIZE == 0)
+    {
+        // Keep the published ratio within bounds of the IO class
+        split_ratio = env_atomic64_read(&splitter->published_split_ratio[size]);
+        bounds = env_atomic_read(&splitter->io_class_bounds[part_id]);
+        pattern->split_ratio = clamp_t(uint64_t, split_ratio, IO_CLASS_BOUNDS_MIN(bounds),
+                                       IO_CLASS_BOUNDS_MAX(bounds));
+    }
+
+    // Increment counters
+    pattern->request_counter++;
+    env_atomic64_inc(&dispatch->submitted);
+    dispatch->submitter_mask |= 1ULL << hash_32(current->pid, SUBMITTER_HASH_BITS);
+
+    // Check for miss first
+    counters = core_counters_get(splitter, dispatch, ocf_core_get_id(req->core));
+    if (ocf_engine_is_miss(req))
+    {
+        send_to_backend = true;
+    }
+    else if (req->info.dirty_any)
+    {
+        // Backend copy of a dirty line is stale, only clean hits are offloaded
+        send_to_backend = false;
+        env_atomic64_inc(&dispatch->dirty_hits);
+        env_atomic64_add(req->byte_length, &dispatch->dirty_hit_bytes);
+        env_atomic64_inc(&counters->dirty_hits);
+        env_atomic64_add(req->byte_length, &counters->dirty_hit_bytes);
+    }
+    else
+    {
+        send_to_backend = dispatch_hit(dispatch, pattern, req->byte_length);
+        path = send_to_backend ? NETCAS_PATH_BACKEND : NETCAS_PATH_CACHE;
+        env_atomic64_inc(&counters->hits[path]);
+        env_atomic64_add(req->byte_length, &counters->hit_bytes[path]);
+
+        // Clean hits may be hedged, each earns its share of the budget
+        hedge_budget = env_atomic_read(&splitter->hedge_budget);
+        if (hedge_budget && env_atomic64_read(&dispatch->hedge_credit) < HEDGE_CREDIT_MAX)
+            env_atomic64_add(hedge_budget, &dispatch->hedge_credit);
+    }
+
+    if (trace_request_sampled(splitter, &dispatch->trace_submits))
+    {
+        trace_request(splitter, req, NETCAS_TRACE_SUBMIT, pattern->split_ratio,
+                      send_to_backend ? NETCAS_PATH_BACKEND : NETCAS_PATH_CACHE, 0, cpu);
+    }
+
+    env_put_execution_context(cpu);
+
+    return send_to_backend;
+}
+
+/**
+ * @brief Note that the engine calls given hook. Once the bit is set the
+ * hook only reads it.
+ */
+static void hook_seen(struct netcas_splitter *splitter, int hook)
+{
+    int hooks = env_atomic_read(&splitter->engine_hooks);
+    int old;
+
+    while (!(hooks & hook))
+    {
+        old = env_atomic_cmpxchg(&splitter->engine_hooks, hooks, hooks | hook);
+        if (old == hooks)
+            break;
+        hooks = old;
+    }
+}
+
+/**
+ * @brief Account completed read served by given path
+ * @param req The OCF request
+ * @param path Path which served the request
+ * @param latency_ns Time from submission to completion of the request
+ */
+void netcas_account_completion(struct ocf_request *req, enum netcas_path path,
+                               uint64_t latency_ns)
+{
+    struct netcas_splitter *splitter = env_netcas_get_splitter(req->cache);
+    enum netcas_size_class size = netcas_size_class(req->byte_length);
+    struct netcas_core_counters *counters;
+    unsigned cpu;
+
+    if (!splitter)
+        return;
+
+    hook_seen(splitter, NETCAS_HOOK_COMPLETION);
+
+    cpu = env_get_execution_context();
+    counters = core_counters_get(splitter, &splitter->dispatch[cpu], ocf_core_get_id(req->core));
+    env_atomic64_add(req->byte_length, &counters->completed_bytes[path]);
+    env_atomic64_add(req->byte_length, &splitter->dispatch[cpu].completed_bytes[path][size]);
+    env_atomic64_inc(&splitter->dispatch[cpu].completed);
+    env_atomic64_inc(&splitter->dispatch[cpu].latency_hist[path][latency_bucket(latency_ns)]);
+    if (trace_request_sampled(splitter, &splitter->dispatch[cpu].trace_completions))
+        trace_request(splitter, req, NETCAS_TRACE_COMPLETION, 0, path, latency_ns, cpu);
+    env_put_execution_context(cpu);
+}
+
+/**
+ * @brief Time after which a read still in flight on given path should be
+ * duplicated to the other path. Only clean hits can be served by both.
+ * @return Delay in ns, 0 if the read must not be hedged
+ */
+uint64_t netcas_hedge_delay(struct ocf_request *req, enum netcas_path path)
+{
+    struct netcas_splitter *splitter = env_netcas_get_splitter(req->cache);
+
+    if (!splitter || path >= NETCAS_PATH_MAX)
+        return 0;
+
+    hook_seen(splitter, NETCAS_HOOK_HEDGE);
+
+    if (ocf_engine_is_miss(req) || req->info.dirty_any)
+        return 0;
+
+    return env_atomic64_read(&splitter->hedge_delay[path]);
+}
+
+/**
+ * @brief Take budget for a duplicate of a read whose hedge delay expired.
+ * Budget is earned and spent per CPU.
+ * @return true if the duplicate may be issued
+ */
+bool netcas_hedge_start(struct ocf_request *req)
+{
+    struct netcas_splitter *splitter = env_netcas_get_splitter(req->cache);
+    struct netcas_dispatch *dispatch;
+    uint64_t credit;
+    bool allowed = false;
+    unsigned cpu;
+
+    if (!splitter || !env_atomic_read(&splitter->hedge_budget))
+        return false;
+
+    cpu = env_get_execution_context();
+    dispatch = &splitter->dispatch[cpu];
+
+    credit = env_atomic64_read(&dispatch->hedge_credit);
+    while (credit >= HEDGE_COST)
+    {
+        if (env_atomic64_cmpxchg(&dispatch->hedge_credit, credit, credit - HEDGE_COST) == credit)
+        {
+            allowed = true;
+            break;
+        }
+        credit = env_atomic64_read(&dispatch->hedge_credit);
+    }
+
+    if (allowed)
+    {
+        // Duplicate completes as any other read, keep in-flight count even
+        env_atomic64_inc(&dispatch->hedges);
+        env_atomic64_inc(&dispatch->submitted);
+    }
+
+    env_put_execution_context(cpu);
+
+    return allowed;
+}
+
+/**
+ * @brief Account the first completion of a hedged read
+ * @param hedge_won true if the duplicate completed before the original
+ */
+void netcas_hedge_complete(struct ocf_request *req, bool hedge_won)
+{
+    struct netcas_splitter *splitter = env_netcas_get_splitter(req->cache);
+    unsigned cpu;
+
+    if (!splitter || !hedge_won)
+        return;
+
+    cpu = env_get_execution_context();
+    env_atomic64_inc(&splitter->dispatch[cpu].hedge_wins);
+    env_put_execution_context(cpu);
+}
+
+/**
+ * @brief Set backend read targets of a core. Takes a free slot on the first
+ * call for the core, count below 2 gives the slot back. Applied by the
+ * monitor at its next step, until then reads keep the previous targets.
+ * @return 0 on success, -OCF_ERR_INVAL on invalid arguments, -OCF_ERR_NO_MEM
+ * if all slots are taken by other cores
+ */
+int netcas_set_targets(struct netcas_splitter *splitter, ocf_core_id_t core_id,
+                       uint32_t count, const uint32_t *bandwidth)
+{
+    struct netcas_target_set *set = NULL;
+    int index, i;
+
+    if (core_id >= OCF_CORE_MAX || count > NETCAS_TARGET_MAX)
+        return -OCF_ERR_INVAL;
+    for (i = 0; i < count; ++i)
+    {
+        if (!bandwidth[i])
+            return -OCF_ERR_INVAL;
+    }
+
+    env_spinlock_lock(&splitter->lock);
+
+    index = splitter->core_target_set[core_id];
+    if (index)
+    {
+        set = &splitter->target_sets[index - 1];
+    }
+    else if (count >= 2)
+    {
+        for (i = 0; i < TARGET_SETS_MAX && splitter->target_sets[i].in_use; ++i)
+            ;
+        if (i == TARGET_SETS_MAX)
+        {
+            env_spinlock_unlock(&splitter->lock);
+            return -OCF_ERR_NO_MEM;
+        }
+        set = &splitter->target_sets[i];
+        set->in_use = true;
+        set->core_id = core_id;
+        splitter->core_target_set[core_id] = i + 1;
+    }
+
+    if (set)
+    {
+        set->requested_count = count >= 2 ? count : 0;
+        for (i = 0; i < set->requested_count; ++i)
+            set->requested_bandwidth[i] = bandwidth[i];
+        set->changed = true;
+
+        if (!set->requested_count)
+        {
+            set->in_use = false;
+            splitter->core_target_set[core_id] = 0;
+        }
+    }
+
+    env_spinlock_unlock(&splitter->lock);
+
+    return 0;
+}
+
+uint32_t netcas_get_targets(struct netcas_splitter *splitter, ocf_core_id_t core_id,
+                            struct netcas_target_stats *stats)
+{
+    struct netcas_target_set *set;
+    uint32_t count = 0;
+    int index, i;
+
+    if (core_id >= OCF_CORE_MAX)
+        return 0;
+
+    env_spinlock_lock(&splitter->lock);
+    index = splitter->core_target_set[core_id];
+    if (index)
+    {
+        set = &splitter->target_sets[index - 1];
+        count = set->count;
+        for (i = 0; i < count; ++i)
+            stats[i] = set->stats[i];
+    }
+    env_spinlock_unlock(&splitter->lock);
+
+    return count;
+}
+
+/**
+ * @brief Pick backend read target with this CPU's weighted round robin
+ * over the weights published for the request's core
+ * @return Target index, 0 if the core has no targets
+ */
+uint32_t netcas_select_target(struct ocf_request *req)
+{
+    struct netcas_splitter *splitter = env_netcas_get_splitter(req->cache);
+    struct netcas_target_dispatch *dispatch;
+    struct netcas_target_set *set;
+    int64_t weight, total = 0;
+    uint32_t count, target = 0;
+    int index, i;
+    unsigned cpu;
+
+    if (!splitter)
+        return 0;
+
+    hook_seen(splitter, NETCAS_HOOK_TARGET);
+
+    index = splitter->core_target_set[ocf_core_get_id(req->core)];
+    if (!index)
+        return 0;
+
+    set = &splitter->target_sets[index - 1];
+    count = env_atomic_read(&set->published_count);
+    if (count < 2)
+        return 0;
+
+    cpu = env_get_execution_context();
+    dispatch_sync(splitter, &splitter->dispatch[cpu]);
+    dispatch = &splitter->dispatch[cpu].targets[index - 1];
+
+    for (i = 0; i < count; ++i)
+    {
+        weight = env_atomic_read(&set->weight[i]);
+        dispatch->credit[i] += (int64_t)req->byte_length * weight;
+        total += weight;
+        if (dispatch->credit[i] > dispatch->credit[target])
+            target = i;
+    }
+    dispatch->credit[target] -= (int64_t)req->byte_length * total;
+
+    env_put_execution_context(cpu);
+
+    return target;
+}
+
+/**
+ * @brief Account completed read served by given backend target
+ * @param req The OCF request
+ * @param target Target index returned by netcas_select_target()
+ * @param latency_ns Time from submission to completion of the request
+ */
+void netcas_account_target_completion(struct ocf_request *req, uint32_t target,
+                                      uint64_t latency_ns)
+{
+    struct netcas_splitter *splitter = env_netcas_get_splitter(req->cache);
+    struct netcas_target_dispatch *dispatch;
+    int index;
+    unsigned cpu;
+
+    if (!splitter || target >= NETCAS_TARGET_MAX)
+        return;
+
+    index = splitter->core_target_set[ocf_core_get_id(req->core)];
+    if (!index)
+        return;
+
+    cpu = env_get_execution_context();
+    dispatch = &splitter->dispatch[cpu].targets[index - 1];
+    env_atomic64_add(req->byte_length, &dispatch->completed_bytes[target]);
+    env_atomic64_inc(&dispatch->completions[target]);
+    env_atomic64_add(latency_ns, &dispatch->latency_sum[target]);
+    env_put_execution_context(cpu);
+}
+
+/**
+ * @brief Get backend admission budget, read on every backend submission
+ * @return bytes/s, 0 if the backend is not throttled
+ */
+uint64_t netcas_get_backend_budget(struct netcas_splitter *splitter)
+{
+    return env_atomic64_read(&splitter->backend_budget);
+}
+
+/**
+ * @brief Get split ratio actually achieved for hits, summed over all CPUs
+ * @return Share of clean hit bytes served by cache in 0-10000 scale
+ */
+uint64_t netcas_get_achieved_ratio(struct netcas_splitter *splitter)
+{
+    uint64_t cache_bytes = 0;
+    uint64_t backend_bytes = 0;
+    int i;
+
+    for (i = 0; i < splitter->cpus_no; ++i)
+    {
+        cache_bytes += env_atomic64_read(&splitter->dispatch[i].hit_bytes[NETCAS_PATH_CACHE]);
+        backend_bytes += env_atomic64_read(&splitter->dispatch[i].hit_bytes[NETCAS_PATH_BACKEND]);
+    }
+
+    if (cache_bytes + backend_bytes == 0)
+        return SPLIT_RATIO_MAX;
+
+    return (cache_bytes * SPLIT_RATIO_SCALE) / (cache_bytes + backend_bytes);
+}
+
+/**
+ * @brief Share of hit bytes which hit dirty cache lines over all CPUs
+ */
+uint64_t netcas_get_dirty_hit_ratio(struct netcas_splitter *splitter)
+{
+    uint64_t hit_bytes = 0;
+    uint64_t dirty_hit_bytes = 0;
+    int i;
+
+    for (i = 0; i < splitter->cpus_no; ++i)
+    {
+        hit_bytes += env_atomic64_read(&splitter->dispatch[i].hit_bytes[NETCAS_PATH_CACHE]);
+        hit_bytes += env_atomic64_read(&splitter->dispatch[i].hit_bytes[NETCAS_PATH_BACKEND]);
+        dirty_hit_bytes += env_atomic64_read(&splitter->dispatch[i].dirty_hit_bytes);
+    }
+
+    if (hit_bytes + dirty_hit_bytes == 0)
+        return 0;
+
+    return (dirty_hit_bytes * SPLIT_RATIO_SCALE) / (hit_bytes + dirty_hit_bytes);
+}
+
+static void core_stats_add(struct netcas_core_stats *stats, struct netcas_core_counters *counters)
+{
+    int path;
+
+    for (path = 0; path < NETCAS_PATH_MAX; ++path)
+    {
+        stats->hits[path] += env_atomic64_read(&counters->hits[path]);
+        stats->hit_bytes[path] += env_atomic64_read(&counters->hit_bytes[path]);
+        stats->completed_bytes[path] += env_atomic64_read(&counters->completed_bytes[path]);
+    }
+    stats->dirty_hits += env_atomic64_read(&counters->dirty_hits);
+    stats->dirty_hit_bytes += env_atomic64_read(&counters->dirty_hit_bytes);
+}
+
+/**
+ * @brief Add statistics of a core counted by all CPUs
+ */
+static void core_stats_add_core(struct netcas_core_stats *stats, struct netcas_splitter *splitter,
+                                ocf_core_id_t core_id)
+{
+    int slot = env_atomic_read(&splitter->core_stats_slot[core_id]);
+    int i;
+
+    if (!slot)
+        return;
+
+    if (slot == CORE_STATS_SHARED)
+    {
+        core_stats_add(stats, &splitter->core_counters[core_id]);
+        return;
+    }
+
+    for (i = 0; i < splitter->cpus_no; ++i)
+        core_stats_add(stats, &splitter->dispatch[i].cores[slot - 1]);
+}
+
+static void core_counters_reset(struct netcas_core_counters *counters)
+{
+    int path;
+
+    for (path = 0; path < NETCAS_PATH_MAX; ++path)
+    {
+        env_atomic64_set(&counters->hits[path], 0);
+        env_atomic64_set(&counters->hit_bytes[path], 0);
+        env_atomic64_set(&counters->completed_bytes[path], 0);
+    }
+    env_atomic64_set(&counters->dirty_hits, 0);
+    env_atomic64_set(&counters->dirty_hit_bytes, 0);
+}
+
+/**
+ * @brief Get statistics of a core for casadm
+ * @param core_id Core, out of range (OCF_CORE_ID_INVALID) sums all cores
+ */
+void netcas_get_core_stats(struct netcas_splitter *splitter, ocf_core_id_t core_id,
+                           struct netcas_core_stats *stats)
+{
+    uint64_t hit_bytes;
+    int i;
+
+    env_memset(stats, sizeof(*stats), 0);
+
+    if (core_id < OCF_CORE_MAX)
+    {
+        core_stats_add_core(stats, splitter, core_id);
+    }
+    else
+    {
+        for (i = 0; i < OCF_CORE_MAX; ++i)
+            core_stats_add_core(stats, splitter, i);
+    }
+
+    hit_bytes = stats->hit_bytes[NETCAS_PATH_CACHE] + stats->hit_bytes[NETCAS_PATH_BACKEND];
+    stats->achieved_ratio = hit_bytes ?
+                            stats->hit_bytes[NETCAS_PATH_CACHE] * SPLIT_RATIO_SCALE / hit_bytes :
+                            SPLIT_RATIO_MAX;
+
+    env_spinlock_lock(&splitter->lock);
+    stats->target_ratio = splitter->telemetry.optimal_ratio;
+    env_spinlock_unlock(&splitter->lock);
+
+    for (i = 0; i < NETCAS_MODE_MAX; ++i)
+        stats->mode_time_us[i] = env_atomic64_read(&splitter->mode_time_us[i]);
+}
+
+/**
+ * @brief Reset statistics of a core, together with casadm counters of OCF
+ * @param core_id Core, out of range resets all cores and time in each mode
+ */
+void netcas_reset_core_stats(struct netcas_splitter *splitter, ocf_core_id_t core_id)
+{
+    int slot, i;
+
+    if (core_id < OCF_CORE_MAX)
+    {
+        slot = env_atomic_read(&splitter->core_stats_slot[core_id]);
+        if (slot == CORE_STATS_SHARED)
+        {
+            core_counters_reset(&splitter->core_counters[core_id]);
+        }
+        else if (slot)
+        {
+            for (i = 0; i < splitter->cpus_no; ++i)
+                core_counters_reset(&splitter->dispatch[i].cores[slot - 1]);
+        }
+        return;
+    }
+
+    for (i = 0; i < OCF_CORE_MAX; ++i)
+        core_counters_reset(&splitter->core_counters[i]);
+    for (i = 0; i < splitter->cpus_no; ++i)
+    {
+        for (slot = 0; slot < CORE_STATS_SLOTS; ++slot)
+            core_counters_reset(&splitter->dispatch[i].cores[slot]);
+    }
+    for (i = 0; i < NETCAS_MODE_MAX; ++i)
+        env_atomic64_set(&splitter->mode_time_us[i], 0);
+}
+
+/**
+ * @brief Get hits routed by one CPU, for checking the per-CPU split
+ */
+void netcas_get_cpu_split_counters(struct netcas_splitter *splitter, uint32_t cpu,
+                                   uint64_t *cache_hits, uint64_t *backend_hits)
+{
+    *cache_hits = 0;
+    *backend_hits = 0;
+
+    if (cpu >= splitter->cpus_no)
+        return;
+
+    *cache_hits = env_atomic64_read(&splitter->dispatch[cpu].cache_hits);
+    *backend_hits = env_atomic64_read(&splitter->dispatch[cpu].backend_hits);
+}
+
+/**
+ * @brief Reset all splitter statistics (useful for testing or reconfiguration).
+ * State is owned by the monitor thread, so reset is done there.
+ */
+void netcas_reset_splitter(struct netcas_splitter *splitter)
+{
+    env_atomic_set(&splitter->reset_requested, 1);
+}
+
+/**
+ * @brief Get runtime tunables
+ */
+void netcas_get_params(struct netcas_splitter *splitter, struct netcas_params *params)
+{
+    env_spinlock_lock(&splitter->lock);
+    *params = splitter->params;
+    env_spinlock_unlock(&splitter->lock);
+}
+
+/**
+ * @brief Set runtime tunables, monitor picks them up at its next step
+ * @return 0 on success, -OCF_ERR_INVAL if any value is out of range
+ */
+int netcas_set_params(struct netcas_splitter *splitter, const struct netcas_params *params)
+{
+    if (params->monitor_interval_ms < MONITOR_INTERVAL_MIN_MS ||
+        params->monitor_interval_ms > MONITOR_INTERVAL_MAX_MS)
+        return -OCF_ERR_INVAL;
+    if (params->log_interval_ms > LOG_INTERVAL_MAX_MS)
+        return -OCF_ERR_INVAL;
+    if (params->latency_congestion_threshold > THRESHOLD_MAX ||
+        params->latency_recovery_threshold > params->latency_congestion_threshold)
+        return -OCF_ERR_INVAL;
+    if (params->pinned_ratio != NETCAS_RATIO_UNPINNED && params->pinned_ratio > SPLIT_RATIO_MAX)
+        return -OCF_ERR_INVAL;
+    if (params->hedge_percentile < HEDGE_PERCENTILE_MIN ||
+        params->hedge_percentile > HEDGE_PERCENTILE_MAX ||
+        params->hedge_budget_permil > HEDGE_BUDGET_MAX)
+        return -OCF_ERR_INVAL;
+
+    env_spinlock_lock(&splitter->lock);
+    splitter->params = *params;
+    env_spinlock_unlock(&splitter->lock);
+
+    return 0;
+}
+
+/**
+ * @brief Get state published by the last monitor step
+ */
+void netcas_get_telemetry(struct netcas_splitter *splitter, struct netcas_telemetry *telemetry)
+{
+    int i;
+
+    env_spinlock_lock(&splitter->lock);
+    *telemetry = splitter->telemetry;
+    env_spinlock_unlock(&splitter->lock);
+
+    telemetry->achieved_ratio = netcas_get_achieved_ratio(splitter);
+    telemetry->dirty_hit_ratio = netcas_get_dirty_hit_ratio(splitter);
+    telemetry->engine_hooks = env_atomic_read(&splitter->engine_hooks);
+
+    telemetry->hedges = 0;
+    telemetry->hedge_wins = 0;
+    for (i = 0; i < splitter->cpus_no; ++i)
+    {
+        telemetry->hedges += env_atomic64_read(&splitter->dispatch[i].hedges);
+        telemetry->hedge_wins += env_atomic64_read(&splitter->dispatch[i].hedge_wins);
+    }
+}
+
+/**
+ * @brief Allocate trace ring. Must be called before the splitter is used.
+ * @return 0 on success, -OCF_ERR_NO_MEM when allocation failed
+ */
+int netcas_trace_init(struct netcas_splitter *splitter, uint32_t entries)
+{
+    struct netcas_trace *trace;
+
+    if (!entries)
+        return 0;
+
+    // Round down to a power of two, so ring index is a mask
+    entries = 1U << (fls64(entries) - 1);
+
+    trace = env_vzalloc(sizeof(*trace) + entries * sizeof(trace->records[0]));
+    if (!trace)
+        return -OCF_ERR_NO_MEM;
+
+    if (env_spinlock_init(&trace->lock))
+    {
+        env_vfree(trace);
+        return -OCF_ERR_NO_MEM;
+    }
+
+    trace->mask = entries - 1;
+    splitter->trace = trace;
+
+    return 0;
+}
+
+bool netcas_trace_enabled(struct netcas_splitter *splitter)
+{
+    return splitter->trace != NULL;
+}
+
+void netcas_trace_set_sampling(struct netcas_splitter *splitter, uint32_t sampling)
+{
+    env_atomic_set(&splitter->trace_sampling, sampling);
+}
+
+uint32_t netcas_trace_get_sampling(struct netcas_splitter *splitter)
+{
+    return env_atomic_read(&splitter->trace_sampling);
+}
+
+void netcas_trace_get_header(struct netcas_splitter *splitter, struct netcas_trace_record *header)
+{
+    env_memset(header, sizeof(*header), 0);
+
+    header->timestamp_ns = env_get_monotonic_ns();
+    header->type = NETCAS_TRACE_HEADER;
+    header->header.version = NETCAS_TRACE_VERSION;
+    header->header.record_size = sizeof(*header);
+    header->header.entries = splitter->trace ? splitter->trace->mask + 1 : 0;
+    header->header.sampling = netcas_trace_get_sampling(splitter);
+}
+
+/**
+ * @brief Copy records starting at reader position. Readers which fell
+ * behind the ring skip to the oldest record still held.
+ * @return Number of records copied
+ */
+uint32_t netcas_trace_read(struct netcas_splitter *splitter, uint64_t *seq,
+                           struct netcas_trace_record *records, uint32_t count)
+{
+    struct netcas_trace *trace = splitter->trace;
+    unsigned long flags;
+    uint64_t oldest;
+    uint32_t copied = 0;
+
+    if (!trace)
+        return 0;
+
+    env_spinlock_lock_irqsave(&trace->lock, flags);
+
+    oldest = trace->head > trace->mask ? trace->head - trace->mask - 1 : 0;
+    if (*seq < oldest)
+        *seq = oldest;
+
+    while (copied < count && *seq < trace->head)
+    {
+        records[copied++] = trace->records[*seq & trace->mask];
+        (*seq)++;
+    }
+
+    env_spinlock_unlock_irqrestore(&trace->lock, flags);
+
+    return copied;
+}
@@ -0,0 +1,311 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __NETCAS_SPLITTER_H__
+#define __NETCAS_SPLITTER_H__
+
+#include "ocf/ocf.h"
+#include "netCAS_common.h"
+
+struct ocf_request;
+
+/* Per-cache splitter context, owned by the adapter (cache_priv->netcas) */
+struct netcas_splitter;
+
+/* Path which served a request */
+enum netcas_path
+{
+    NETCAS_PATH_CACHE,
+    NETCAS_PATH_BACKEND,
+    NETCAS_PATH_MAX,
+};
+
+/* Backend read targets of one core, e.g. replicas serving the same data */
+#define NETCAS_TARGET_MAX 8
+
+/* Request size class, hits of each class are split with their own ratio */
+enum netcas_size_class
+{
+    NETCAS_SIZE_SMALL,  /* Up to 16 KiB */
+    NETCAS_SIZE_MEDIUM, /* Up to 128 KiB */
+    NETCAS_SIZE_LARGE,
+    NETCAS_SIZE_MAX,
+};
+
+/* Controller which picks the split ratio */
+enum netcas_policy
+{
+    NETCAS_POLICY_FORMULA,    /* A/(A+B) from the bandwidth model */
+    NETCAS_POLICY_HILL_CLIMB, /* Closed-loop search on completed IOPS */
+    NETCAS_POLICY_MAX,
+};
+
+/* Number of splitter modes, NETCAS_MODE_FAILURE is the last one */
+#define NETCAS_MODE_MAX (NETCAS_MODE_FAILURE + 1)
+
+/* Split ratio isn't pinned, controllers pick it */
+#define NETCAS_RATIO_UNPINNED ((uint32_t)-1)
+
+/* Engine hooks reported in telemetry once called, statistics they feed stay zero until then */
+#define NETCAS_HOOK_COMPLETION (1 << 0) /* netcas_account_completion() */
+#define NETCAS_HOOK_HEDGE      (1 << 1) /* netcas_hedge_delay() */
+#define NETCAS_HOOK_TARGET     (1 << 2) /* netcas_select_target() */
+
+/* Runtime tunables of a splitter, thresholds in permil */
+struct netcas_params
+{
+    uint32_t monitor_interval_ms;
+    uint32_t log_interval_ms;               /* 0 - no periodic kernel log */
+    uint32_t latency_congestion_threshold;  /* Floors under the noise scaled */
+    uint32_t latency_recovery_threshold;    /* congestion thresholds */
+    uint32_t pinned_ratio;                  /* 0-10000 or NETCAS_RATIO_UNPINNED */
+    uint32_t hedge_percentile;              /* Latency percentile of a path to hedge at */
+    uint32_t hedge_budget_permil;           /* Hedges per clean hits, 0 - no hedging */
+};
+
+/* Splitter state published by the monitor after every step */
+struct netcas_telemetry
+{
+    uint32_t mode;
+    uint32_t policy;
+    uint64_t optimal_ratio;
+    uint64_t published_ratio[NETCAS_SIZE_MAX];
+    uint64_t achieved_ratio;                /* Clean hits only */
+    uint64_t dirty_hit_ratio;               /* Dirty share of hit bytes */
+    uint64_t rdma_throughput_average;
+    uint64_t max_rdma_throughput_average;
+    uint64_t rdma_latency_average;
+    uint64_t min_rdma_latency_average;      /* Baseline, 0 if not established */
+    uint64_t bw_drop_permil;
+    uint64_t latency_increase_permil;
+    uint64_t path_throughput[NETCAS_PATH_MAX];
+    uint64_t path_p99[NETCAS_PATH_MAX];
+    uint64_t hedge_delay[NETCAS_PATH_MAX];  /* ns, 0 - path not hedged */
+    uint64_t hedges;                        /* Duplicates issued */
+    uint64_t hedge_wins;                    /* Duplicates which completed first */
+    uint64_t io_depth;
+    uint64_t numjob;
+    int64_t tail_bias;
+    uint64_t backend_budget;                /* Bytes/s, 0 - backend not throttled */
+    uint32_t engine_hooks;                  /* NETCAS_HOOK_* called by the engine */
+};
+
+/* Cumulative statistics of one core, or of all cores of the cache */
+struct netcas_core_stats
+{
+    uint64_t hits[NETCAS_PATH_MAX];         /* Clean hits routed to each path */
+    uint64_t hit_bytes[NETCAS_PATH_MAX];
+    uint64_t dirty_hits;                    /* Kept on cache */
+    uint64_t dirty_hit_bytes;
+    uint64_t completed_bytes[NETCAS_PATH_MAX]; /* Reads served by each path */
+    uint64_t achieved_ratio;                /* Cache share of clean hit bytes, 0-10000 */
+    uint64_t target_ratio;                  /* Optimal ratio of the cache, 0-10000 */
+    uint64_t mode_time_us[NETCAS_MODE_MAX]; /* Time the cache spent in each mode */
+};
+
+/* State of a backend read target published by the monitor */
+struct netcas_target_stats
+{
+    uint32_t bandwidth;         /* Nominal, MiB/s */
+    uint32_t weight;            /* Share of backend reads of the core, 0-10000 */
+    uint64_t throughput;        /* Bytes/s in the last sample */
+    uint64_t latency;           /* Smoothed completion latency, ns */
+    uint64_t latency_reference; /* Latency of the fastest target of the core, ns */
+    bool congested;
+};
+
+/* Trace format version, bumped on any change of the record layout */
+#define NETCAS_TRACE_VERSION 2
+
+/* Trace record types */
+enum netcas_trace_type
+{
+    NETCAS_TRACE_HEADER = 1, /* First record of a readout */
+    NETCAS_TRACE_SAMPLE,     /* Monitor sample */
+    NETCAS_TRACE_SUBMIT,     /* Routing decision of a sampled request */
+    NETCAS_TRACE_COMPLETION, /* Completion of a sampled request */
+};
+
+/* Lookup result of a traced request */
+enum netcas_trace_hit
+{
+    NETCAS_TRACE_MISS,
+    NETCAS_TRACE_HIT_CLEAN,
+    NETCAS_TRACE_HIT_DIRTY,
+};
+
+/*
+ * Trace record, 32 bytes in host byte order. Values which don't fit their
+ * field saturate. Gaps in seq mean records overwritten before readout.
+ */
+struct netcas_trace_record
+{
+    uint64_t timestamp_ns;
+    uint32_t seq;
+    uint8_t type;
+    uint8_t mode;           /* Splitter mode when recorded */
+    uint16_t ratio;         /* Sample - optimal ratio, submit - ratio applied */
+    union
+    {
+        struct
+        {
+            uint32_t version;
+            uint32_t record_size;
+            uint32_t entries;
+            uint32_t sampling;
+        } header;
+        struct
+        {
+            uint32_t rdma_throughput;
+            uint32_t rdma_latency_ns;
+            uint32_t iops;
+            uint16_t bw_drop_permil;
+            uint16_t latency_increase_permil;
+        } sample;
+        struct
+        {
+            uint32_t bytes;
+            uint32_t latency_ns; /* Completion only */
+            uint16_t part_id;
+            uint8_t path;
+            uint8_t hit;        /* enum netcas_trace_hit */
+            uint32_t cpu;
+        } request;
+    };
+} __attribute__((packed));
+
+/* Set debug level of the splitter */
+void netcas_set_debug(int debug_level);
+
+/* Allocate splitter context for a cache */
+int netcas_splitter_init(ocf_cache_t cache, struct netcas_splitter **splitter);
+
+/* Free splitter context, cache must be stopped */
+void netcas_splitter_deinit(struct netcas_splitter *splitter);
+
+/* Run one monitor step, returns ms after which it should run again */
+uint32_t netcas_monitor_run(struct netcas_splitter *splitter);
+
+/* Decide whether request should be served by backend (true) or cache.
+ * Hits on dirty cache lines are always served by cache */
+bool netcas_should_send_to_backend(struct ocf_request *req);
+
+/* Account completed read served by given path, called by the engine with
+ * the time elapsed between submission and completion of the request */
+void netcas_account_completion(struct ocf_request *req, enum netcas_path path,
+                               uint64_t latency_ns);
+
+/* Delay in ns after which a read still in flight on given path should be
+ * duplicated to the other path, 0 - don't hedge. Completions of both copies
+ * are accounted with netcas_account_completion() */
+uint64_t netcas_hedge_delay(struct ocf_request *req, enum netcas_path path);
+
+/* Take hedge budget when the delay expired, false - don't issue duplicate */
+bool netcas_hedge_start(struct ocf_request *req);
+
+/* Account first completion of a hedged read */
+void netcas_hedge_complete(struct ocf_request *req, bool hedge_won);
+
+/* Set backend read targets of a core with their nominal bandwidth in MiB/s.
+ * Reads routed to backend are spread over the targets in proportion to
+ * their bandwidth, congested targets are drained. Count 0 or 1 drops them */
+int netcas_set_targets(struct netcas_splitter *splitter, ocf_core_id_t core_id,
+                       uint32_t count, const uint32_t *bandwidth);
+
+/* Get state of backend read targets of a core, returns number of targets */
+uint32_t netcas_get_targets(struct netcas_splitter *splitter, ocf_core_id_t core_id,
+                            struct netcas_target_stats *stats);
+
+/* Pick backend read target of a request routed to backend, 0 if its core
+ * has no targets set */
+uint32_t netcas_select_target(struct ocf_request *req);
+
+/* Account completed read served by given backend target, called by the
+ * engine along with netcas_account_completion() */
+void netcas_account_target_completion(struct ocf_request *req, uint32_t target,
+                                      uint64_t latency_ns);
+
+/* Bytes/s all backend submissions of the cache may take while the backend
+ * is congested, 0 when it is not throttled */
+uint64_t netcas_get_backend_budget(struct netcas_splitter *splitter);
+
+/* Reset split pattern, windows and mode machine to defaults at the next
+ * monitor step */
+void netcas_reset_splitter(struct netcas_splitter *splitter);
+
+/* Get runtime tunables */
+void netcas_get_params(struct netcas_splitter *splitter, struct netcas_params *params);
+
+/* Set runtime tunables, applied at the next monitor step */
+int netcas_set_params(struct netcas_splitter *splitter, const struct netcas_params *params);
+
+/* Get state published by the last monitor step */
+void netcas_get_telemetry(struct netcas_splitter *splitter, struct netcas_telemetry *telemetry);
+
+/* Select split ratio controller, applied at the next monitor step */
+void netcas_set_policy(struct netcas_splitter *splitter, enum netcas_policy policy);
+
+/* Split ratio controller currently requested */
+enum netcas_policy netcas_get_policy(struct netcas_splitter *splitter);
+
+/* Bound share of hits of an IO class served by cache, 0-10000 scale */
+int netcas_set_io_class_bounds(struct netcas_splitter *splitter, ocf_part_id_t part_id,
+                               uint16_t min_ratio, uint16_t max_ratio);
+
+/* Get split ratio bounds of an IO class */
+void netcas_get_io_class_bounds(struct netcas_splitter *splitter, ocf_part_id_t part_id,
+                                uint16_t *min_ratio, uint16_t *max_ratio);
+
+/* Set p99 completion latency objective per path in ns, 0 disables it */
+void netcas_set_p99_target(struct netcas_splitter *splitter, uint64_t target_ns);
+
+/* p99 completion latency objective in ns */
+uint64_t netcas_get_p99_target(struct netcas_splitter *splitter);
+
+/* p99 completion latency of given path measured in the last period, ns */
+uint64_t netcas_get_path_p99(struct netcas_splitter *splitter, enum netcas_path path);
+
+/* Share of clean hit bytes served by cache over all CPUs, 0-10000 scale */
+uint64_t netcas_get_achieved_ratio(struct netcas_splitter *splitter);
+
+/* Share of hit bytes which hit dirty lines and so were kept on cache,
+ * 0-10000 scale */
+uint64_t netcas_get_dirty_hit_ratio(struct netcas_splitter *splitter);
+
+/* Allocate trace ring of given number of records, rounded down to a power
+ * of two. Must be called before the splitter is used, 0 disables tracing */
+int netcas_trace_init(struct netcas_splitter *splitter, uint32_t entries);
+
+/* Trace ring is allocated */
+bool netcas_trace_enabled(struct netcas_splitter *splitter);
+
+/* Trace one in given number of requests, 0 traces monitor samples only */
+void netcas_trace_set_sampling(struct netcas_splitter *splitter, uint32_t sampling);
+
+/* Request sampling of the trace */
+uint32_t netcas_trace_get_sampling(struct netcas_splitter *splitter);
+
+/* Fill header record describing the trace */
+void netcas_trace_get_header(struct netcas_splitter *splitter, struct netcas_trace_record *header);
+
+/* Copy records starting at reader position seq, which is moved past the
+ * copied ones and over overwritten ones. Returns number of records copied */
+uint32_t netcas_trace_read(struct netcas_splitter *splitter, uint64_t *seq,
+                           struct netcas_trace_record *records, uint32_t count);
+
+/* Get statistics of a core, core_id out of range (OCF_CORE_ID_INVALID)
+ * sums all cores of the cache */
+void netcas_get_core_stats(struct netcas_splitter *splitter, ocf_core_id_t core_id,
+                           struct netcas_core_stats *stats);
+
+/* Reset statistics of a core, core_id out of range resets all cores and
+ * time in each mode */
+void netcas_reset_core_stats(struct netcas_splitter *splitter, ocf_core_id_t core_id);
+
+/* Hits routed to each path by given CPU */
+void netcas_get_cpu_split_counters(struct netcas_splitter *splitter, uint32_t cpu,
+                                   uint64_t *cache_hits, uint64_t *backend_hits);
+
+#endif /* __NETCAS_SPLITTER_H__ */
@@ -0,0 +1,21 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __NETCAS_SIM_LINUX_BITOPS_H__
+#define __NETCAS_SIM_LINUX_BITOPS_H__
+
+#include <linux/types.h>
+
+static inline unsigned int hweight64(uint64_t w)
+{
+	return __builtin_popcountll(w);
+}
+
+static inline int fls64(uint64_t x)
+{
+	return x ? 64 - __builtin_clzll(x) : 0;
+}
+
+#endif /* __NETCAS_SIM_LINUX_BITOPS_H__ */
@@ -0,0 +1,18 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __NETCAS_SIM_LINUX_HASH_H__
+#define __NETCAS_SIM_LINUX_HASH_H__
+
+#include <linux/types.h>
+
+#define GOLDEN_RATIO_32 0x61C88647
+
+static inline uint32_t hash_32(uint32_t val, unsigned int bits)
+{
+	return (val * GOLDEN_RATIO_32) >> (32 - bits);
+}
+
+#endif /* __NETCAS_SIM_LINUX_HASH_H__ */
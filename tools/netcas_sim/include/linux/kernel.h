@@ -0,0 +1,37 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __NETCAS_SIM_LINUX_KERNEL_H__
+#define __NETCAS_SIM_LINUX_KERNEL_H__
+
+#include <stdio.h>
+
+/* Kernel log goes to stdout only when the simulator runs verbose */
+extern int netcas_sim_verbose;
+
+#define KERN_INFO ""
+
+#define printk(fmt, ...) ({ \
+		if (netcas_sim_verbose) \
+			printf(fmt, ##__VA_ARGS__); \
+	})
+
+#define max_t(type, x, y) ({ \
+		type __x = (x); \
+		type __y = (y); \
+		__x > __y ? __x : __y; \
+	})
+
+#define min_t(type, x, y) ({ \
+		type __x = (x); \
+		type __y = (y); \
+		__x < __y ? __x : __y; \
+	})
+
+#define clamp_t(type, val, lo, hi) min_t(type, max_t(type, val, lo), hi)
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+#endif /* __NETCAS_SIM_LINUX_KERNEL_H__ */
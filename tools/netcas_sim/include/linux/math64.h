@@ -0,0 +1,16 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __NETCAS_SIM_LINUX_MATH64_H__
+#define __NETCAS_SIM_LINUX_MATH64_H__
+
+#include <linux/types.h>
+
+static inline uint64_t div64_u64(uint64_t dividend, uint64_t divisor)
+{
+	return dividend / divisor;
+}
+
+#endif /* __NETCAS_SIM_LINUX_MATH64_H__ */
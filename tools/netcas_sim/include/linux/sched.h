@@ -0,0 +1,18 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __NETCAS_SIM_LINUX_SCHED_H__
+#define __NETCAS_SIM_LINUX_SCHED_H__
+
+/* Simulated job which is running at the moment */
+struct task_struct {
+	int pid;
+};
+
+extern struct task_struct netcas_sim_task;
+
+#define current (&netcas_sim_task)
+
+#endif /* __NETCAS_SIM_LINUX_SCHED_H__ */
@@ -0,0 +1,42 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __NETCAS_SIM_LINUX_TYPES_H__
+#define __NETCAS_SIM_LINUX_TYPES_H__
+
+#ifdef NETCAS_SIM_KERNEL_TYPES
+/*
+ * netCAS sources are kernel code and print 64-bit values as %llu, so they
+ * are built with 64-bit types being long long as in the kernel. Signed
+ * intN_t come from the C library, which defines them in sys/types.h, and
+ * are cast when printed.
+ */
+#include <sys/types.h>
+
+typedef unsigned long long u64;
+typedef unsigned int u32;
+typedef unsigned short u16;
+typedef unsigned char u8;
+typedef long long s64;
+typedef int s32;
+
+typedef u64 uint64_t;
+typedef u32 uint32_t;
+typedef u16 uint16_t;
+typedef u8 uint8_t;
+
+#define UINT64_MAX (~0ULL)
+#else
+#include <stdint.h>
+
+typedef uint64_t u64;
+typedef uint32_t u32;
+typedef uint16_t u16;
+typedef uint8_t u8;
+typedef int64_t s64;
+typedef int32_t s32;
+#endif
+
+#endif /* __NETCAS_SIM_LINUX_TYPES_H__ */
@@ -0,0 +1,31 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __OCF_H__
+#define __OCF_H__
+
+/*
+ * Minimal OCF API for building netCAS sources in the simulator. Types are
+ * opaque to netCAS and error codes are only reported, never persisted.
+ */
+
+#include "ocf_env.h"
+
+#define OCF_USER_IO_CLASS_MAX 33
+#define OCF_CORE_MAX 4096
+
+#define OCF_ERR_MIN 1000000
+#define OCF_ERR_INVAL OCF_ERR_MIN
+#define OCF_ERR_NO_MEM (OCF_ERR_MIN + 1)
+
+typedef struct ocf_cache *ocf_cache_t;
+typedef struct ocf_core *ocf_core_t;
+typedef uint16_t ocf_core_id_t;
+typedef uint16_t ocf_part_id_t;
+
+const char *ocf_cache_get_name(ocf_cache_t cache);
+ocf_core_id_t ocf_core_get_id(ocf_core_t core);
+
+#endif /* __OCF_H__ */
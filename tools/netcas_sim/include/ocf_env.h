@@ -0,0 +1,289 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __OCF_ENV_H__
+#define __OCF_ENV_H__
+
+/*
+ * Userspace env for the netCAS simulator. Mirrors the subset of
+ * modules/cas_cache/ocf_env.h used by netCAS sources. Time and execution
+ * context come from the simulator, not from the host.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <linux/types.h>
+
+/* Simulated clock in ns and CPU of the running job, owned by the simulator */
+extern uint64_t netcas_sim_clock_ns;
+extern unsigned netcas_sim_cpu;
+extern unsigned netcas_sim_cpus;
+
+#define ENV_MEM_NORMAL	0
+#define ENV_MEM_NOIO	0
+
+/* *** MEMORY MANAGEMENT *** */
+
+static inline void *env_malloc(size_t size, int flags)
+{
+	return malloc(size);
+}
+
+static inline void *env_zalloc(size_t size, int flags)
+{
+	return calloc(1, size);
+}
+
+static inline void env_free(const void *ptr)
+{
+	free((void *)ptr);
+}
+
+static inline void *env_vmalloc(size_t size)
+{
+	return malloc(size);
+}
+
+static inline void *env_vzalloc(size_t size)
+{
+	return calloc(1, size);
+}
+
+static inline void env_vfree(const void *ptr)
+{
+	free((void *)ptr);
+}
+
+/* *** ATOMIC VARIABLES *** */
+
+typedef struct {
+	int counter;
+} env_atomic;
+
+typedef struct {
+	long long counter;
+} env_atomic64;
+
+static inline int env_atomic_read(const env_atomic *a)
+{
+	return __atomic_load_n(&a->counter, __ATOMIC_RELAXED);
+}
+
+static inline void env_atomic_set(env_atomic *a, int i)
+{
+	__atomic_store_n(&a->counter, i, __ATOMIC_RELAXED);
+}
+
+static inline void env_atomic_add(int i, env_atomic *a)
+{
+	__atomic_add_fetch(&a->counter, i, __ATOMIC_SEQ_CST);
+}
+
+static inline void env_atomic_sub(int i, env_atomic *a)
+{
+	__atomic_sub_fetch(&a->counter, i, __ATOMIC_SEQ_CST);
+}
+
+static inline void env_atomic_inc(env_atomic *a)
+{
+	env_atomic_add(1, a);
+}
+
+static inline void env_atomic_dec(env_atomic *a)
+{
+	env_atomic_sub(1, a);
+}
+
+static inline int env_atomic_add_return(int i, env_atomic *a)
+{
+	return __atomic_add_fetch(&a->counter, i, __ATOMIC_SEQ_CST);
+}
+
+static inline int env_atomic_sub_return(int i, env_atomic *a)
+{
+	return __atomic_sub_fetch(&a->counter, i, __ATOMIC_SEQ_CST);
+}
+
+static inline int env_atomic_inc_return(env_atomic *a)
+{
+	return env_atomic_add_return(1, a);
+}
+
+static inline int env_atomic_dec_return(env_atomic *a)
+{
+	return env_atomic_sub_return(1, a);
+}
+
+static inline int env_atomic_cmpxchg(env_atomic *a, int old, int new_value)
+{
+	__atomic_compare_exchange_n(&a->counter, &old, new_value, false,
+			__ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	return old;
+}
+
+static inline u64 env_atomic64_read(const env_atomic64 *a)
+{
+	return __atomic_load_n(&a->counter, __ATOMIC_RELAXED);
+}
+
+static inline void env_atomic64_set(env_atomic64 *a, u64 i)
+{
+	__atomic_store_n(&a->counter, i, __ATOMIC_RELAXED);
+}
+
+static inline void env_atomic64_add(u64 i, env_atomic64 *a)
+{
+	__atomic_add_fetch(&a->counter, i, __ATOMIC_SEQ_CST);
+}
+
+static inline void env_atomic64_sub(u64 i, env_atomic64 *a)
+{
+	__atomic_sub_fetch(&a->counter, i, __ATOMIC_SEQ_CST);
+}
+
+static inline void env_atomic64_inc(env_atomic64 *a)
+{
+	env_atomic64_add(1, a);
+}
+
+static inline void env_atomic64_dec(env_atomic64 *a)
+{
+	env_atomic64_sub(1, a);
+}
+
+static inline u64 env_atomic64_inc_return(env_atomic64 *a)
+{
+	return __atomic_add_fetch(&a->counter, 1, __ATOMIC_SEQ_CST);
+}
+
+static inline u64 env_atomic64_cmpxchg(env_atomic64 *a, u64 old, u64 new)
+{
+	long long expected = old;
+
+	__atomic_compare_exchange_n(&a->counter, &expected, new, false,
+			__ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	return expected;
+}
+
+/* *** SPIN LOCKS *** */
+
+typedef struct {
+	pthread_mutex_t lock;
+} env_spinlock;
+
+static inline int env_spinlock_init(env_spinlock *l)
+{
+	return pthread_mutex_init(&l->lock, NULL);
+}
+
+static inline void env_spinlock_lock(env_spinlock *l)
+{
+	pthread_mutex_lock(&l->lock);
+}
+
+static inline void env_spinlock_unlock(env_spinlock *l)
+{
+	pthread_mutex_unlock(&l->lock);
+}
+
+static inline void env_spinlock_destroy(env_spinlock *l)
+{
+	pthread_mutex_destroy(&l->lock);
+}
+
+#define env_spinlock_lock_irqsave(l, flags) \
+		({ (void)(flags); env_spinlock_lock(l); })
+
+#define env_spinlock_unlock_irqrestore(l, flags) \
+		({ (void)(flags); env_spinlock_unlock(l); })
+
+/* *** TIME *** */
+
+/* One tick is one simulated nanosecond */
+static inline uint64_t env_get_tick_count(void)
+{
+	return netcas_sim_clock_ns;
+}
+
+static inline uint64_t env_get_monotonic_ns(void)
+{
+	return netcas_sim_clock_ns;
+}
+
+static inline uint64_t env_ticks_to_nsecs(uint64_t j)
+{
+	return j;
+}
+
+static inline uint64_t env_ticks_to_usecs(uint64_t j)
+{
+	return j / 1000;
+}
+
+static inline uint64_t env_ticks_to_msecs(uint64_t j)
+{
+	return j / 1000000;
+}
+
+static inline uint64_t env_ticks_to_secs(uint64_t j)
+{
+	return j / 1000000000;
+}
+
+static inline uint64_t env_secs_to_ticks(uint64_t j)
+{
+	return j * 1000000000;
+}
+
+/* *** STRING OPERATIONS *** */
+
+#define env_memset(dest, dmax, val) ({ \
+		memset(dest, val, dmax); \
+		0; \
+	})
+#define env_memcpy(dest, dmax, src, slen) ({ \
+		memcpy(dest, src, slen < dmax ? slen : dmax); \
+		0; \
+	})
+
+/* *** DEBUGING *** */
+
+#define ENV_PRIu64 "llu"
+#define ENV_PRId64 "lld"
+
+#define ENV_WARN(cond, fmt...)		({ if (cond) fprintf(stderr, fmt); })
+#define ENV_WARN_ON(cond)		({ if (cond) fprintf(stderr, \
+		"WARNING at %s:%d\n", __FILE__, __LINE__); })
+
+#define ENV_BUG()			abort()
+#define ENV_BUG_ON(cond)		({ if (cond) abort(); })
+
+/* *** EXECUTION CONTEXTS *** */
+
+static inline unsigned env_get_execution_context(void)
+{
+	return netcas_sim_cpu;
+}
+
+static inline void env_put_execution_context(unsigned ctx)
+{
+}
+
+static inline unsigned env_get_execution_context_count(void)
+{
+	return netcas_sim_cpus;
+}
+
+/* *** netCAS *** */
+
+struct ocf_cache;
+struct netcas_splitter;
+struct netcas_splitter *env_netcas_get_splitter(struct ocf_cache *cache);
+
+#endif /* __OCF_ENV_H__ */
@@ -0,0 +1,21 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef ENGINE_COMMON_H_
+#define ENGINE_COMMON_H_
+
+#include "../ocf_request.h"
+
+static inline bool ocf_engine_is_hit(struct ocf_request *req)
+{
+	return req->hit;
+}
+
+static inline bool ocf_engine_is_miss(struct ocf_request *req)
+{
+	return !ocf_engine_is_hit(req);
+}
+
+#endif /* ENGINE_COMMON_H_ */
@@ -0,0 +1,30 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef NETCAS_COMMON_H_
+#define NETCAS_COMMON_H_
+
+/* Must be kept in line with ocf/src/engine/netCAS_common.h */
+
+#define SPLIT_RATIO_MIN 0
+#define SPLIT_RATIO_MAX 10000
+#define SPLIT_RATIO_SCALE 10000
+
+#define RDMA_WINDOW_SIZE 20
+
+typedef enum {
+	NETCAS_MODE_IDLE,
+	NETCAS_MODE_WARMUP,
+	NETCAS_MODE_STABLE,
+	NETCAS_MODE_CONGESTION,
+	NETCAS_MODE_FAILURE,
+} netCAS_mode_t;
+
+#define NETCAS_DEBUG_LOG(cache, format, ...) ({ \
+		if (netCAS_debug) \
+			printk(format "\n", ##__VA_ARGS__); \
+	})
+
+#endif /* NETCAS_COMMON_H_ */
@@ -0,0 +1,20 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef NETCAS_MONITOR_H_
+#define NETCAS_MONITOR_H_
+
+#include "ocf/ocf.h"
+
+/* Backend link metrics, provided by the simulated link instead of RDMA */
+struct performance_metrics {
+	uint64_t rdma_throughput; /* MiB/s */
+	uint64_t rdma_latency; /* ns */
+	uint64_t iops;
+};
+
+struct performance_metrics measure_performance(uint64_t elapsed_time);
+
+#endif /* NETCAS_MONITOR_H_ */
@@ -0,0 +1,28 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __OCF_REQUEST_H__
+#define __OCF_REQUEST_H__
+
+#include "ocf/ocf.h"
+
+/* Lookup result reduced to counters netCAS looks at */
+struct ocf_req_info {
+	uint32_t dirty_any;
+};
+
+/* Request fields used by netCAS, lookup result reduced to a hit flag */
+struct ocf_request {
+	ocf_cache_t cache;
+	ocf_core_t core;
+	uint64_t byte_position;
+	uint32_t byte_length;
+	ocf_part_id_t part_id;
+	int rw;
+	bool hit;
+	struct ocf_req_info info;
+};
+
+#endif /* __OCF_REQUEST_H__ */
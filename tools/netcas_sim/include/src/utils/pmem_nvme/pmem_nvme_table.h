@@ -0,0 +1,13 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PMEM_NVME_TABLE_H_
+#define PMEM_NVME_TABLE_H_
+
+/* Bandwidth in MiB/s at given split ratio (100 - cache only, 0 - backend
+ * only), derived from the simulated device models */
+int lookup_bandwidth(int io_depth, int numjob, int split_ratio);
+
+#endif /* PMEM_NVME_TABLE_H_ */
@@ -0,0 +1,499 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Offline replay of a netCAS trace.
+ *
+ * Reads a trace captured from /sys/kernel/debug/opencas/<cache>/netcas_trace
+ * (or written by netcas_sim --trace) and feeds it to splitters running each
+ * alternative policy. Monitor samples are returned by measure_performance()
+ * from the last sample recorded before the simulated time, sampled requests
+ * are routed again and their completions accounted with captured latencies.
+ * Every policy is reported next to the captured run: mode transitions, time
+ * spent in each mode, mean optimal ratio and share of sampled hit bytes
+ * routed to cache. Sampled requests are too sparse to follow per-request
+ * patterns, so routing is compared by share rather than decision by decision.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim_env.h"
+
+#define REPLAY_MAX_RUNS 8
+
+struct replay_stats {
+	const char *name;
+	uint64_t mode_ns[NETCAS_MODE_FAILURE + 1];
+	uint32_t transitions;
+	uint64_t ratio_sum;
+	uint64_t ratio_samples;
+
+	/* Bytes of sampled hits routed to each path */
+	uint64_t hit_bytes[NETCAS_PATH_MAX];
+};
+
+struct replay_run {
+	int policy;
+	uint32_t pinned_ratio;
+	struct ocf_cache cache;
+	struct ocf_core core;
+	netCAS_mode_t mode;
+	uint64_t mode_since_ns;
+	uint64_t next_monitor_ns;
+	struct replay_stats stats;
+};
+
+struct replay {
+	struct netcas_trace_record header;
+	struct netcas_trace_record *records;
+	uint64_t count;
+	uint64_t lost;
+
+	/* Bandwidth returned to the bandwidth model, MiB/s */
+	uint64_t cache_bw;
+	uint64_t backend_bw;
+	uint32_t interval_ms;
+	uint64_t p99_target_ns;
+
+	/* Last monitor sample replayed */
+	struct performance_metrics metrics;
+
+	struct replay_run runs[REPLAY_MAX_RUNS];
+	uint32_t runs_no;
+	struct replay_stats capture;
+};
+
+static struct replay *replay_instance;
+
+/* *** Hooks called by netCAS sources *** */
+
+int lookup_bandwidth(int io_depth, int numjob, int split_ratio)
+{
+	struct replay *replay = replay_instance;
+
+	return split_ratio ? replay->cache_bw : replay->backend_bw;
+}
+
+struct performance_metrics measure_performance(uint64_t elapsed_time)
+{
+	return replay_instance->metrics;
+}
+
+/* *** Trace *** */
+
+static int replay_load(struct replay *replay, const char *path)
+{
+	struct netcas_trace_record *records = NULL;
+	uint64_t size = 0, i;
+	uint32_t cpus = 1;
+	FILE *file;
+
+	file = fopen(path, "rb");
+	if (!file) {
+		perror(path);
+		return -errno;
+	}
+
+	if (fread(&replay->header, sizeof(replay->header), 1, file) != 1 ||
+			replay->header.type != NETCAS_TRACE_HEADER) {
+		fprintf(stderr, "%s: not a netCAS trace\n", path);
+		goto invalid;
+	}
+	if (replay->header.header.version != NETCAS_TRACE_VERSION ||
+			replay->header.header.record_size != sizeof(*records)) {
+		fprintf(stderr, "%s: trace version %u, record size %u "
+				"not supported\n", path,
+				replay->header.header.version,
+				replay->header.header.record_size);
+		goto invalid;
+	}
+
+	for (;;) {
+		if (replay->count == size) {
+			size = size ? size * 2 : 4096;
+			records = realloc(records, size * sizeof(*records));
+			if (!records) {
+				fclose(file);
+				return -ENOMEM;
+			}
+		}
+		if (fread(&records[replay->count], sizeof(*records), 1, file) != 1)
+			break;
+		replay->count++;
+	}
+	fclose(file);
+
+	for (i = 0; i < replay->count; i++) {
+		if (i && records[i].seq != (uint32_t)(records[i - 1].seq + 1))
+			replay->lost += (uint32_t)(records[i].seq - records[i - 1].seq - 1);
+		if (records[i].type != NETCAS_TRACE_SAMPLE &&
+				records[i].request.cpu >= cpus)
+			cpus = records[i].request.cpu + 1;
+	}
+
+	replay->records = records;
+	netcas_sim_cpus = cpus;
+
+	return 0;
+
+invalid:
+	fclose(file);
+	return -EINVAL;
+}
+
+static void stats_mode(struct replay_stats *stats, netCAS_mode_t *mode,
+		uint64_t *since_ns, netCAS_mode_t new_mode, uint64_t now_ns)
+{
+	stats->mode_ns[*mode] += now_ns - *since_ns;
+	*since_ns = now_ns;
+
+	if (new_mode != *mode) {
+		stats->transitions++;
+		*mode = new_mode;
+	}
+}
+
+/* Summary of the captured run itself */
+static void replay_capture(struct replay *replay)
+{
+	struct replay_stats *stats = &replay->capture;
+	netCAS_mode_t mode = NETCAS_MODE_IDLE;
+	uint64_t since_ns, i;
+
+	if (!replay->count)
+		return;
+
+	stats->name = "capture";
+	since_ns = replay->records[0].timestamp_ns;
+
+	for (i = 0; i < replay->count; i++) {
+		struct netcas_trace_record *record = &replay->records[i];
+
+		if (record->mode > NETCAS_MODE_FAILURE)
+			continue;
+
+		stats_mode(stats, &mode, &since_ns, record->mode,
+				record->timestamp_ns);
+
+		if (record->type == NETCAS_TRACE_SAMPLE) {
+			stats->ratio_sum += record->ratio;
+			stats->ratio_samples++;
+		} else if (record->type == NETCAS_TRACE_SUBMIT && record->request.hit) {
+			stats->hit_bytes[record->request.path] += record->request.bytes;
+		}
+	}
+}
+
+/* *** Replay *** */
+
+static int run_init(struct replay *replay, struct replay_run *run)
+{
+	struct netcas_params params;
+	int result;
+
+	run->cache.name = "replay";
+	run->mode = NETCAS_MODE_IDLE;
+	run->mode_since_ns = replay->records[0].timestamp_ns;
+	run->next_monitor_ns = replay->records[0].timestamp_ns;
+
+	result = netcas_splitter_init(&run->cache, &run->cache.splitter);
+	if (result)
+		return result;
+
+	netcas_set_policy(run->cache.splitter, run->policy);
+	netcas_set_p99_target(run->cache.splitter, replay->p99_target_ns);
+
+	netcas_get_params(run->cache.splitter, &params);
+	if (replay->interval_ms)
+		params.monitor_interval_ms = replay->interval_ms;
+	params.pinned_ratio = run->pinned_ratio;
+
+	return netcas_set_params(run->cache.splitter, &params);
+}
+
+static void run_monitor(struct replay_run *run)
+{
+	struct netcas_telemetry telemetry;
+	uint32_t ms;
+
+	netcas_sim_clock_ns = run->next_monitor_ns;
+
+	ms = netcas_monitor_run(run->cache.splitter);
+	netcas_get_telemetry(run->cache.splitter, &telemetry);
+
+	stats_mode(&run->stats, &run->mode, &run->mode_since_ns,
+			telemetry.mode, netcas_sim_clock_ns);
+	run->stats.ratio_sum += telemetry.optimal_ratio;
+	run->stats.ratio_samples++;
+
+	run->next_monitor_ns += (uint64_t)(ms ?: 1) * NSEC_PER_MSEC;
+}
+
+static void run_record(struct replay *replay, struct replay_run *run,
+		struct netcas_trace_record *record)
+{
+	struct ocf_request req = { 0 };
+	enum netcas_path path;
+
+	netcas_sim_clock_ns = record->timestamp_ns;
+
+	if (record->type == NETCAS_TRACE_SAMPLE) {
+		replay->metrics.rdma_throughput = record->sample.rdma_throughput;
+		replay->metrics.rdma_latency = record->sample.rdma_latency_ns;
+		replay->metrics.iops = record->sample.iops;
+		return;
+	}
+
+	req.cache = &run->cache;
+	req.core = &run->core;
+	req.byte_length = record->request.bytes;
+	req.part_id = record->request.part_id;
+	req.hit = record->request.hit != NETCAS_TRACE_MISS;
+	req.info.dirty_any = record->request.hit == NETCAS_TRACE_HIT_DIRTY;
+	sim_run_as(record->request.cpu);
+
+	if (record->type == NETCAS_TRACE_SUBMIT) {
+		path = netcas_should_send_to_backend(&req) ?
+				NETCAS_PATH_BACKEND : NETCAS_PATH_CACHE;
+		if (req.hit)
+			run->stats.hit_bytes[path] += req.byte_length;
+	} else if (record->type == NETCAS_TRACE_COMPLETION) {
+		netcas_account_completion(&req, record->request.path,
+				record->request.latency_ns);
+	}
+}
+
+static int replay_run(struct replay *replay, struct replay_run *run)
+{
+	uint64_t i;
+	int result;
+
+	memset(&replay->metrics, 0, sizeof(replay->metrics));
+
+	result = run_init(replay, run);
+	if (result)
+		return result;
+
+	for (i = 0; i < replay->count; i++) {
+		struct netcas_trace_record *record = &replay->records[i];
+
+		while (run->next_monitor_ns < record->timestamp_ns)
+			run_monitor(run);
+
+		run_record(replay, run, record);
+	}
+
+	stats_mode(&run->stats, &run->mode, &run->mode_since_ns, run->mode,
+			replay->records[replay->count - 1].timestamp_ns);
+
+	netcas_splitter_deinit(run->cache.splitter);
+
+	return 0;
+}
+
+/* *** Report *** */
+
+static void report_stats(struct replay_stats *stats)
+{
+	uint64_t ratio = stats->ratio_samples ?
+			stats->ratio_sum / stats->ratio_samples : 0;
+	uint64_t hit_bytes = stats->hit_bytes[NETCAS_PATH_CACHE] +
+			stats->hit_bytes[NETCAS_PATH_BACKEND];
+	uint64_t total_ns = 0;
+	int mode;
+
+	for (mode = 0; mode <= NETCAS_MODE_FAILURE; mode++)
+		total_ns += stats->mode_ns[mode];
+
+	printf("%-16s %11u %6" PRIu64 ".%02" PRIu64, stats->name,
+			stats->transitions, ratio / 100, ratio % 100);
+
+	for (mode = 0; mode <= NETCAS_MODE_FAILURE; mode++) {
+		printf(" %10.1f", total_ns ?
+				stats->mode_ns[mode] * 100.0 / total_ns : 0.0);
+	}
+
+	if (hit_bytes) {
+		printf(" %9.1f", stats->hit_bytes[NETCAS_PATH_CACHE] * 100.0 /
+				hit_bytes);
+	} else {
+		printf(" %9s", "-");
+	}
+	printf("\n");
+}
+
+static void replay_report(struct replay *replay)
+{
+	uint32_t i;
+	int mode;
+
+	printf("Records: %" PRIu64 ", lost: %" PRIu64 ", duration: %.3f s, "
+			"request sampling: 1/%u\n\n", replay->count, replay->lost,
+			(double)(replay->records[replay->count - 1].timestamp_ns -
+				replay->records[0].timestamp_ns) / NSEC_PER_SEC,
+			replay->header.header.sampling);
+
+	printf("%-16s %11s %9s", "Policy", "Transitions", "Ratio [%]");
+	for (mode = 0; mode <= NETCAS_MODE_FAILURE; mode++)
+		printf(" %10s", sim_mode_names[mode]);
+	printf(" %9s\n", "Cache [%]");
+
+	report_stats(&replay->capture);
+	for (i = 0; i < replay->runs_no; i++)
+		report_stats(&replay->runs[i].stats);
+}
+
+/* *** Command line *** */
+
+static void usage(const char *name)
+{
+	printf("Usage: %s [option...] TRACE\n"
+		"  --cache-bw MIBPS       cache bandwidth for bandwidth model (default 3000)\n"
+		"  --backend-bw MIBPS     backend bandwidth for bandwidth model (default 2000)\n"
+		"  --pin RATIO            also replay split pinned to RATIO/100 %%, may be repeated\n"
+		"  --p99-target US        p99 objective, 0 disables it (default 0)\n"
+		"  --interval MS          monitor interval (default splitter default)\n"
+		"  --verbose              print splitter log\n", name);
+}
+
+enum {
+	OPT_CACHE_BW = 256,
+	OPT_BACKEND_BW,
+	OPT_PIN,
+	OPT_P99_TARGET,
+	OPT_INTERVAL,
+	OPT_VERBOSE,
+	OPT_HELP,
+};
+
+static const struct option options[] = {
+	{ "cache-bw", required_argument, NULL, OPT_CACHE_BW },
+	{ "backend-bw", required_argument, NULL, OPT_BACKEND_BW },
+	{ "pin", required_argument, NULL, OPT_PIN },
+	{ "p99-target", required_argument, NULL, OPT_P99_TARGET },
+	{ "interval", required_argument, NULL, OPT_INTERVAL },
+	{ "verbose", no_argument, NULL, OPT_VERBOSE },
+	{ "help", no_argument, NULL, OPT_HELP },
+	{ 0 }
+};
+
+static void add_run(struct replay *replay, const char *name, int policy,
+		uint32_t pinned_ratio)
+{
+	struct replay_run *run = &replay->runs[replay->runs_no++];
+
+	run->policy = policy;
+	run->pinned_ratio = pinned_ratio;
+	run->stats.name = name;
+}
+
+static int parse_args(struct replay *replay, int argc, char *argv[])
+{
+	uint64_t value;
+	char *end;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
+		switch (opt) {
+		case OPT_VERBOSE:
+			netcas_sim_verbose = 1;
+			netcas_set_debug(1);
+			continue;
+		case OPT_HELP:
+			usage(argv[0]);
+			exit(0);
+		case '?':
+			return -EINVAL;
+		}
+
+		errno = 0;
+		value = strtoull(optarg, &end, 10);
+		if (errno || end == optarg || *end)
+			goto invalid;
+
+		switch (opt) {
+		case OPT_CACHE_BW:
+			replay->cache_bw = value;
+			break;
+		case OPT_BACKEND_BW:
+			replay->backend_bw = value;
+			break;
+		case OPT_PIN:
+			if (value > SPLIT_RATIO_MAX ||
+					replay->runs_no == REPLAY_MAX_RUNS)
+				goto invalid;
+			add_run(replay, strdup(optarg), NETCAS_POLICY_FORMULA, value);
+			break;
+		case OPT_P99_TARGET:
+			replay->p99_target_ns = value * NSEC_PER_USEC;
+			break;
+		case OPT_INTERVAL:
+			replay->interval_ms = value;
+			break;
+		}
+	}
+
+	if (optind != argc - 1 || !replay->cache_bw || !replay->backend_bw) {
+		fprintf(stderr, "Invalid configuration\n");
+		return -EINVAL;
+	}
+
+	return 0;
+
+invalid:
+	fprintf(stderr, "Invalid value '%s' of option --%s\n", optarg,
+			options[opt - OPT_CACHE_BW].name);
+	return -EINVAL;
+}
+
+int main(int argc, char *argv[])
+{
+	static struct replay replay = {
+		.cache_bw = 3000,
+		.backend_bw = 2000,
+	};
+	uint32_t i;
+	int result;
+
+	replay_instance = &replay;
+	add_run(&replay, "formula", NETCAS_POLICY_FORMULA, NETCAS_RATIO_UNPINNED);
+	add_run(&replay, "hill-climb", NETCAS_POLICY_HILL_CLIMB,
+			NETCAS_RATIO_UNPINNED);
+
+	if (parse_args(&replay, argc, argv)) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	result = replay_load(&replay, argv[optind]);
+	if (result)
+		return 2;
+
+	if (!replay.count) {
+		fprintf(stderr, "%s: no records to replay\n", argv[optind]);
+		return 2;
+	}
+
+	replay_capture(&replay);
+
+	for (i = 0; i < replay.runs_no; i++) {
+		result = replay_run(&replay, &replay.runs[i]);
+		if (result) {
+			fprintf(stderr, "Failed to replay %s: %d\n",
+					replay.runs[i].stats.name, result);
+			return 2;
+		}
+	}
+
+	replay_report(&replay);
+	free(replay.records);
+
+	return 0;
+}
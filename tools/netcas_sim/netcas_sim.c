@@ -0,0 +1,1128 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Discrete-event simulator of the netCAS splitter.
+ *
+ * Closed loop jobs keep a fixed number of reads in flight. Every read is
+ * routed by netcas_should_send_to_backend() to one of two simulated links:
+ * the local cache device or the backend link. Each link is a FIFO pipe with
+ * a bandwidth and a fixed latency, so throughput against queue depth follows
+ * from the pipe model. The backend may be a set of replicated targets, each
+ * with its own pipe, picked by netcas_select_target(). Congestion episodes
+ * scale backend bandwidth and add latency for a period of time, on all
+ * targets or just one. The splitter monitor runs on the simulated clock at
+ * the interval it asks for.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <linux/kernel.h>
+#include "sim_env.h"
+
+#define SIM_MAX_EPISODES 16
+#define SIM_MAX_SIZES 8
+
+/* Read latency histogram, 1 us buckets, slower reads land in the last one */
+#define SIM_LATENCY_BUCKETS 100000
+
+/* Trace ring records, drained at every monitor step */
+#define SIM_TRACE_ENTRIES (1U << 16)
+
+struct sim_episode {
+	uint64_t start_ns;
+	uint64_t end_ns;
+	uint32_t bw_percent;
+	uint64_t extra_latency_ns;
+	int target; /* -1 - whole backend */
+};
+
+struct sim_link {
+	uint64_t bandwidth; /* bytes/s */
+	uint64_t latency_ns;
+	uint64_t busy_until_ns;
+
+	/* Counters of the current monitor interval */
+	uint64_t bytes;
+	uint64_t completions;
+	uint64_t latency_sum_ns;
+};
+
+struct sim_config {
+	uint64_t duration_ns;
+	uint32_t jobs;
+	uint32_t qd;
+	uint32_t sizes[SIM_MAX_SIZES];
+	uint32_t sizes_no;
+	uint32_t hit_percent;
+	uint32_t dirty_percent;
+	int policy;
+	uint64_t p99_target_ns;
+	uint32_t interval_ms;
+	uint64_t timer_slack_ns; /* Monitor wakes up late by up to that much */
+	uint64_t seed;
+	const char *timeline;
+	const char *trace;
+	uint32_t trace_sampling;
+	uint32_t hedge_budget; /* permil */
+	uint32_t hedge_percentile; /* permil, 0 - splitter default */
+
+	/* Pass criteria, 0 - not checked */
+	uint32_t max_ratio_error; /* 0.01% */
+	uint64_t min_throughput; /* MiB/s */
+	uint64_t max_tail_latency; /* p99.9, us */
+	uint32_t max_transitions;
+
+	struct sim_episode episodes[SIM_MAX_EPISODES];
+	uint32_t episodes_no;
+
+	/* Backend read targets, 0 - backend is a single link */
+	uint32_t target_bw[NETCAS_TARGET_MAX]; /* MiB/s */
+	uint32_t targets_no;
+};
+
+enum sim_event_type {
+	SIM_EVENT_COMPLETION,
+	SIM_EVENT_HEDGE,
+	SIM_EVENT_MONITOR,
+};
+
+struct sim_event {
+	uint64_t time_ns;
+	enum sim_event_type type;
+	uint32_t job;
+	uint32_t slot;
+	uint32_t gen;
+	bool hedge;
+	enum netcas_path path;
+	uint32_t target;
+	uint64_t submit_ns;
+	struct ocf_request req;
+};
+
+/* Read slot of a job, reused by the next read once the first copy completes */
+struct sim_read {
+	uint32_t gen;
+	bool done;
+	bool hedged;
+	uint64_t submit_ns;
+};
+
+struct sim_heap {
+	struct sim_event *events;
+	uint32_t count;
+	uint32_t size;
+};
+
+struct sim {
+	struct sim_config cfg;
+	struct ocf_cache cache;
+	struct ocf_core core;
+	struct sim_heap heap;
+	struct sim_link link[NETCAS_PATH_MAX];
+	struct sim_link target[NETCAS_TARGET_MAX];
+	uint64_t target_bytes[NETCAS_TARGET_MAX];
+	uint64_t rng;
+
+	/* Hit bytes routed in the current monitor interval */
+	uint64_t hit_bytes[NETCAS_PATH_MAX];
+
+	struct sim_read *reads;
+	uint64_t *latency_hist;
+
+	/* Run totals */
+	uint64_t total_bytes;
+	uint64_t reads_completed;
+	uint64_t ratio_error_sum;
+	uint64_t ratio_samples;
+	uint32_t transitions;
+	netCAS_mode_t mode;
+	uint64_t last_monitor_ns;
+	FILE *timeline;
+	FILE *trace;
+	uint64_t trace_seq;
+	struct netcas_trace_record trace_records[256];
+};
+
+static struct sim *sim_instance;
+
+/* *** Hooks called by netCAS sources *** */
+
+static bool episode_active(struct sim_episode *episode, int target,
+		uint64_t now_ns)
+{
+	if (episode->target >= 0 && episode->target != target)
+		return false;
+
+	return now_ns >= episode->start_ns && now_ns < episode->end_ns;
+}
+
+/* Bandwidth of a backend target, or of the whole backend link for -1 */
+static uint64_t target_bandwidth(struct sim *sim, int target, uint64_t now_ns)
+{
+	uint64_t bandwidth = target < 0 ? sim->link[NETCAS_PATH_BACKEND].bandwidth :
+			sim->target[target].bandwidth;
+	uint32_t i;
+
+	for (i = 0; i < sim->cfg.episodes_no; i++) {
+		struct sim_episode *episode = &sim->cfg.episodes[i];
+
+		if (episode_active(episode, target, now_ns))
+			bandwidth = bandwidth * episode->bw_percent / 100;
+	}
+
+	return bandwidth ?: 1;
+}
+
+static uint64_t target_latency(struct sim *sim, int target, uint64_t now_ns)
+{
+	uint64_t latency = target < 0 ? sim->link[NETCAS_PATH_BACKEND].latency_ns :
+			sim->target[target].latency_ns;
+	uint32_t i;
+
+	for (i = 0; i < sim->cfg.episodes_no; i++) {
+		struct sim_episode *episode = &sim->cfg.episodes[i];
+
+		if (episode_active(episode, target, now_ns))
+			latency += episode->extra_latency_ns;
+	}
+
+	return latency;
+}
+
+static uint64_t link_bandwidth(struct sim *sim, enum netcas_path path,
+		uint64_t now_ns)
+{
+	uint64_t bandwidth = 0;
+	uint32_t i;
+
+	if (path != NETCAS_PATH_BACKEND)
+		return sim->link[path].bandwidth;
+	if (!sim->cfg.targets_no)
+		return target_bandwidth(sim, -1, now_ns);
+
+	for (i = 0; i < sim->cfg.targets_no; i++)
+		bandwidth += target_bandwidth(sim, i, now_ns);
+
+	return bandwidth;
+}
+
+/* Throughput a closed loop of given parallelism gets from an idle link */
+static uint64_t link_throughput(struct sim *sim, enum netcas_path path,
+		uint64_t inflight, uint64_t size)
+{
+	uint64_t bandwidth = link_bandwidth(sim, path, 0);
+	uint64_t transfer_ns = size * NSEC_PER_SEC / bandwidth;
+	uint64_t cycle_ns = transfer_ns + sim->link[path].latency_ns;
+	uint64_t bound = inflight * size * NSEC_PER_SEC / (cycle_ns ?: 1);
+
+	return bound < bandwidth ? bound : bandwidth;
+}
+
+int lookup_bandwidth(int io_depth, int numjob, int split_ratio)
+{
+	struct sim *sim = sim_instance;
+	enum netcas_path path = split_ratio ? NETCAS_PATH_CACHE :
+			NETCAS_PATH_BACKEND;
+
+	return link_throughput(sim, path, (uint64_t)io_depth * numjob,
+			sim->cfg.sizes[0]) / MiB;
+}
+
+struct performance_metrics measure_performance(uint64_t elapsed_time)
+{
+	struct sim *sim = sim_instance;
+	struct sim_link *backend = &sim->link[NETCAS_PATH_BACKEND];
+	struct sim_link *cache = &sim->link[NETCAS_PATH_CACHE];
+	struct performance_metrics metrics = { 0 };
+	uint64_t elapsed_ns = netcas_sim_clock_ns - sim->last_monitor_ns;
+
+	if (!elapsed_ns)
+		return metrics;
+
+	metrics.rdma_throughput = backend->bytes * NSEC_PER_SEC / elapsed_ns / MiB;
+	if (backend->completions)
+		metrics.rdma_latency = backend->latency_sum_ns / backend->completions;
+	metrics.iops = (backend->completions + cache->completions) *
+			NSEC_PER_SEC / elapsed_ns;
+
+	return metrics;
+}
+
+/* *** Event queue *** */
+
+static int heap_init(struct sim_heap *heap, uint32_t size)
+{
+	heap->events = calloc(size, sizeof(*heap->events));
+	if (!heap->events)
+		return -ENOMEM;
+
+	heap->count = 0;
+	heap->size = size;
+
+	return 0;
+}
+
+static void heap_swap(struct sim_heap *heap, uint32_t a, uint32_t b)
+{
+	struct sim_event tmp = heap->events[a];
+
+	heap->events[a] = heap->events[b];
+	heap->events[b] = tmp;
+}
+
+static void heap_push(struct sim_heap *heap, const struct sim_event *event)
+{
+	uint32_t i;
+
+	/* Hedging leaves losing copies in flight, so the queue may grow */
+	if (heap->count == heap->size) {
+		heap->size *= 2;
+		heap->events = realloc(heap->events,
+				heap->size * sizeof(*heap->events));
+		if (!heap->events) {
+			fprintf(stderr, "Out of memory\n");
+			exit(2);
+		}
+	}
+
+	i = heap->count++;
+
+	heap->events[i] = *event;
+	while (i && heap->events[(i - 1) / 2].time_ns > heap->events[i].time_ns) {
+		heap_swap(heap, i, (i - 1) / 2);
+		i = (i - 1) / 2;
+	}
+}
+
+static void heap_pop(struct sim_heap *heap, struct sim_event *event)
+{
+	uint32_t i = 0, child;
+
+	*event = heap->events[0];
+	heap->events[0] = heap->events[--heap->count];
+
+	while ((child = 2 * i + 1) < heap->count) {
+		if (child + 1 < heap->count && heap->events[child + 1].time_ns <
+				heap->events[child].time_ns)
+			child++;
+		if (heap->events[i].time_ns <= heap->events[child].time_ns)
+			break;
+		heap_swap(heap, i, child);
+		i = child;
+	}
+}
+
+/* *** Workload *** */
+
+static uint64_t sim_random(struct sim *sim)
+{
+	/* xorshift64 */
+	sim->rng ^= sim->rng << 13;
+	sim->rng ^= sim->rng >> 7;
+	sim->rng ^= sim->rng << 17;
+
+	return sim->rng;
+}
+
+/* Queue read copy on its link and schedule its completion */
+static void sim_issue(struct sim *sim, struct sim_event *event)
+{
+	struct sim_link *link = &sim->link[event->path];
+	uint64_t now = netcas_sim_clock_ns;
+	uint64_t start, transfer_ns, bandwidth, latency;
+
+	if (event->path == NETCAS_PATH_CACHE) {
+		bandwidth = link->bandwidth;
+		latency = link->latency_ns;
+	} else if (sim->cfg.targets_no) {
+		event->target = netcas_select_target(&event->req);
+		link = &sim->target[event->target];
+		bandwidth = target_bandwidth(sim, event->target, now);
+		latency = target_latency(sim, event->target, now);
+	} else {
+		bandwidth = target_bandwidth(sim, -1, now);
+		latency = target_latency(sim, -1, now);
+	}
+
+	transfer_ns = event->req.byte_length * NSEC_PER_SEC / bandwidth;
+	start = link->busy_until_ns > now ? link->busy_until_ns : now;
+	link->busy_until_ns = start + transfer_ns;
+
+	event->type = SIM_EVENT_COMPLETION;
+	event->submit_ns = now;
+	event->time_ns = link->busy_until_ns + latency;
+
+	heap_push(&sim->heap, event);
+}
+
+static void sim_submit(struct sim *sim, uint32_t job, uint32_t slot)
+{
+	struct sim_read *read = &sim->reads[slot];
+	struct sim_event event = { 0 };
+	uint64_t delay_ns;
+
+	read->gen++;
+	read->done = false;
+	read->hedged = false;
+	read->submit_ns = netcas_sim_clock_ns;
+
+	event.job = job;
+	event.slot = slot;
+	event.gen = read->gen;
+	event.req.cache = &sim->cache;
+	event.req.core = &sim->core;
+	event.req.byte_length = sim->cfg.sizes[sim_random(sim) % sim->cfg.sizes_no];
+	event.req.hit = sim_random(sim) % 100 < sim->cfg.hit_percent;
+	event.req.info.dirty_any = event.req.hit &&
+			sim_random(sim) % 100 < sim->cfg.dirty_percent;
+
+	sim_run_as(job);
+	event.path = netcas_should_send_to_backend(&event.req) ?
+			NETCAS_PATH_BACKEND : NETCAS_PATH_CACHE;
+
+	if (event.req.hit)
+		sim->hit_bytes[event.path] += event.req.byte_length;
+
+	sim_issue(sim, &event);
+
+	delay_ns = netcas_hedge_delay(&event.req, event.path);
+	if (delay_ns) {
+		event.type = SIM_EVENT_HEDGE;
+		event.time_ns = netcas_sim_clock_ns + delay_ns;
+		event.path = !event.path;
+		heap_push(&sim->heap, &event);
+	}
+}
+
+/* Hedge delay of a read expired, duplicate it if it's still in flight */
+static void sim_hedge(struct sim *sim, struct sim_event *event)
+{
+	struct sim_read *read = &sim->reads[event->slot];
+
+	if (read->gen != event->gen || read->done)
+		return;
+
+	sim_run_as(event->job);
+	if (!netcas_hedge_start(&event->req))
+		return;
+
+	read->hedged = true;
+	event->hedge = true;
+	sim_issue(sim, event);
+}
+
+static void sim_complete(struct sim *sim, struct sim_event *event)
+{
+	struct sim_link *link = &sim->link[event->path];
+	struct sim_read *read = &sim->reads[event->slot];
+	uint64_t latency_ns = event->time_ns - event->submit_ns;
+	uint64_t bucket;
+
+	/* Both copies of a hedged read load their links */
+	sim_run_as(event->job);
+	netcas_account_completion(&event->req, event->path, latency_ns);
+	if (event->path == NETCAS_PATH_BACKEND && sim->cfg.targets_no) {
+		netcas_account_target_completion(&event->req, event->target,
+				latency_ns);
+		sim->target_bytes[event->target] += event->req.byte_length;
+	}
+
+	link->bytes += event->req.byte_length;
+	link->completions++;
+	link->latency_sum_ns += latency_ns;
+
+	/* Later copy of a hedged read is dropped */
+	if (read->gen != event->gen || read->done)
+		return;
+
+	read->done = true;
+	if (read->hedged)
+		netcas_hedge_complete(&event->req, event->hedge);
+
+	bucket = (netcas_sim_clock_ns - read->submit_ns) / NSEC_PER_USEC;
+	sim->latency_hist[bucket < SIM_LATENCY_BUCKETS ? bucket :
+			SIM_LATENCY_BUCKETS - 1]++;
+	sim->reads_completed++;
+	sim->total_bytes += event->req.byte_length;
+
+	sim_submit(sim, event->job, event->slot);
+}
+
+/* *** Monitor *** */
+
+/* Append records traced since the last call to the trace file */
+static void sim_trace_drain(struct sim *sim)
+{
+	uint32_t count;
+
+	if (!sim->trace)
+		return;
+
+	do {
+		count = netcas_trace_read(sim->cache.splitter, &sim->trace_seq,
+				sim->trace_records, ARRAY_SIZE(sim->trace_records));
+		fwrite(sim->trace_records, sizeof(sim->trace_records[0]), count,
+				sim->trace);
+	} while (count);
+}
+
+/* Cache share of hits a bandwidth proportional split would give */
+static uint64_t sim_ideal_ratio(struct sim *sim, uint64_t now_ns)
+{
+	uint64_t cache = link_bandwidth(sim, NETCAS_PATH_CACHE, now_ns);
+	uint64_t backend = link_bandwidth(sim, NETCAS_PATH_BACKEND, now_ns);
+
+	return cache * SPLIT_RATIO_MAX / (cache + backend);
+}
+
+static void sim_monitor(struct sim *sim)
+{
+	struct netcas_telemetry telemetry;
+	uint64_t now = netcas_sim_clock_ns;
+	uint64_t hits, ratio = 0, ideal, error = 0;
+	struct sim_event event = { 0 };
+	uint32_t ms;
+	int path;
+
+	ms = netcas_monitor_run(sim->cache.splitter);
+	netcas_get_telemetry(sim->cache.splitter, &telemetry);
+	sim_trace_drain(sim);
+
+	if (telemetry.mode != sim->mode) {
+		printf("%10.3f s  %-10s -> %s\n", (double)now / NSEC_PER_SEC,
+				sim_mode_names[sim->mode], sim_mode_names[telemetry.mode]);
+		sim->mode = telemetry.mode;
+		sim->transitions++;
+	}
+
+	ideal = sim_ideal_ratio(sim, now);
+	hits = sim->hit_bytes[NETCAS_PATH_CACHE] + sim->hit_bytes[NETCAS_PATH_BACKEND];
+	if (hits) {
+		ratio = sim->hit_bytes[NETCAS_PATH_CACHE] * SPLIT_RATIO_MAX / hits;
+		error = ratio > ideal ? ratio - ideal : ideal - ratio;
+		sim->ratio_error_sum += error;
+		sim->ratio_samples++;
+	}
+
+	if (sim->timeline) {
+		uint64_t elapsed = now - sim->last_monitor_ns ?: 1;
+
+		fprintf(sim->timeline, "%" PRIu64 ",%s,%" PRIu64 ",%" PRIu64
+				",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+				now / NSEC_PER_MSEC, sim_mode_names[telemetry.mode],
+				telemetry.optimal_ratio, ratio, ideal,
+				sim->link[NETCAS_PATH_CACHE].bytes * NSEC_PER_SEC /
+					elapsed / MiB,
+				sim->link[NETCAS_PATH_BACKEND].bytes * NSEC_PER_SEC /
+					elapsed / MiB,
+				telemetry.rdma_latency_average / NSEC_PER_USEC);
+	}
+
+	for (path = 0; path < NETCAS_PATH_MAX; path++) {
+		sim->link[path].bytes = 0;
+		sim->link[path].completions = 0;
+		sim->link[path].latency_sum_ns = 0;
+		sim->hit_bytes[path] = 0;
+	}
+	sim->last_monitor_ns = now;
+
+	event.type = SIM_EVENT_MONITOR;
+	event.time_ns = now + (uint64_t)ms * NSEC_PER_MSEC;
+	if (sim->cfg.timer_slack_ns)
+		event.time_ns += sim_random(sim) % sim->cfg.timer_slack_ns;
+	heap_push(&sim->heap, &event);
+}
+
+/* *** Setup *** */
+
+static int sim_init(struct sim *sim)
+{
+	struct sim_event event = { 0 };
+	struct netcas_params params;
+	uint32_t job, i;
+	int result;
+
+	sim->cache.name = "cache1";
+	sim->rng = sim->cfg.seed ?: 1;
+	sim->mode = NETCAS_MODE_IDLE;
+	sim_instance = sim;
+
+	result = netcas_splitter_init(&sim->cache, &sim->cache.splitter);
+	if (result)
+		return result;
+
+	if (sim->cfg.targets_no) {
+		result = netcas_set_targets(sim->cache.splitter, sim->core.id,
+				sim->cfg.targets_no, sim->cfg.target_bw);
+		if (result)
+			return result;
+	}
+
+	netcas_set_policy(sim->cache.splitter, sim->cfg.policy);
+	netcas_set_p99_target(sim->cache.splitter, sim->cfg.p99_target_ns);
+
+	netcas_get_params(sim->cache.splitter, &params);
+	if (sim->cfg.interval_ms)
+		params.monitor_interval_ms = sim->cfg.interval_ms;
+	if (sim->cfg.hedge_percentile)
+		params.hedge_percentile = sim->cfg.hedge_percentile;
+	params.hedge_budget_permil = sim->cfg.hedge_budget;
+	result = netcas_set_params(sim->cache.splitter, &params);
+	if (result)
+		return result;
+
+	if (sim->trace) {
+		struct netcas_trace_record header;
+
+		result = netcas_trace_init(sim->cache.splitter, SIM_TRACE_ENTRIES);
+		if (result)
+			return result;
+
+		netcas_trace_set_sampling(sim->cache.splitter,
+				sim->cfg.trace_sampling);
+		netcas_trace_get_header(sim->cache.splitter, &header);
+		fwrite(&header, sizeof(header), 1, sim->trace);
+	}
+
+	sim->reads = calloc(sim->cfg.jobs * sim->cfg.qd, sizeof(*sim->reads));
+	sim->latency_hist = calloc(SIM_LATENCY_BUCKETS,
+			sizeof(*sim->latency_hist));
+	if (!sim->reads || !sim->latency_hist)
+		return -ENOMEM;
+
+	result = heap_init(&sim->heap, 2 * sim->cfg.jobs * sim->cfg.qd + 1);
+	if (result)
+		return result;
+
+	for (job = 0; job < sim->cfg.jobs; job++) {
+		for (i = 0; i < sim->cfg.qd; i++)
+			sim_submit(sim, job, job * sim->cfg.qd + i);
+	}
+
+	event.type = SIM_EVENT_MONITOR;
+	heap_push(&sim->heap, &event);
+
+	return 0;
+}
+
+static void sim_deinit(struct sim *sim)
+{
+	netcas_splitter_deinit(sim->cache.splitter);
+	free(sim->heap.events);
+	free(sim->reads);
+	free(sim->latency_hist);
+}
+
+static void sim_run(struct sim *sim)
+{
+	struct sim_event event;
+
+	while (sim->heap.count) {
+		heap_pop(&sim->heap, &event);
+		if (event.time_ns >= sim->cfg.duration_ns)
+			break;
+
+		netcas_sim_clock_ns = event.time_ns;
+
+		if (event.type == SIM_EVENT_MONITOR)
+			sim_monitor(sim);
+		else if (event.type == SIM_EVENT_HEDGE)
+			sim_hedge(sim, &event);
+		else
+			sim_complete(sim, &event);
+	}
+
+	sim_trace_drain(sim);
+}
+
+/* Read latency in us at given permil of completed reads */
+static uint64_t sim_latency_percentile(struct sim *sim, uint32_t permil)
+{
+	uint64_t rank = (sim->reads_completed * permil + 999) / 1000;
+	uint64_t cumulative = 0;
+	uint64_t bucket;
+
+	for (bucket = 0; bucket < SIM_LATENCY_BUCKETS - 1; bucket++) {
+		cumulative += sim->latency_hist[bucket];
+		if (cumulative >= rank)
+			break;
+	}
+
+	return bucket;
+}
+
+static int sim_report(struct sim *sim)
+{
+	struct netcas_telemetry telemetry;
+	struct netcas_core_stats core_stats;
+	uint64_t tail_latency = sim_latency_percentile(sim, 999);
+	uint64_t throughput = sim->total_bytes / MiB * MSEC_PER_SEC /
+			(sim->cfg.duration_ns / NSEC_PER_MSEC);
+	uint64_t ratio_error = sim->ratio_samples ?
+			sim->ratio_error_sum / sim->ratio_samples : 0;
+	uint64_t backend_bytes = 0;
+	int result = 0;
+	uint32_t i;
+
+	printf("Achieved throughput:  %" PRIu64 " MiB/s\n", throughput);
+	printf("Achieved split ratio: %" PRIu64 ".%02" PRIu64 " %%\n",
+			netcas_get_achieved_ratio(sim->cache.splitter) / 100,
+			netcas_get_achieved_ratio(sim->cache.splitter) % 100);
+	printf("Dirty hit ratio:      %" PRIu64 ".%02" PRIu64 " %%\n",
+			netcas_get_dirty_hit_ratio(sim->cache.splitter) / 100,
+			netcas_get_dirty_hit_ratio(sim->cache.splitter) % 100);
+	printf("Mean ratio error:     %" PRIu64 ".%02" PRIu64 " %%\n",
+			ratio_error / 100, ratio_error % 100);
+	netcas_get_core_stats(sim->cache.splitter, sim->core.id, &core_stats);
+	printf("Offloaded hits:       %" PRIu64 " (%" PRIu64 " MiB)\n",
+			core_stats.hits[NETCAS_PATH_BACKEND],
+			core_stats.hit_bytes[NETCAS_PATH_BACKEND] / MiB);
+	printf("Mode transitions:     %u\n", sim->transitions);
+	printf("Read latency p99:     %" PRIu64 " us\n",
+			sim_latency_percentile(sim, 990));
+	printf("Read latency p99.9:   %" PRIu64 " us\n", tail_latency);
+
+	for (i = 0; i < sim->cfg.targets_no; i++)
+		backend_bytes += sim->target_bytes[i];
+	for (i = 0; i < sim->cfg.targets_no; i++) {
+		printf("Target %u share:       %" PRIu64 ".%02" PRIu64 " %%\n", i,
+				sim->target_bytes[i] * SPLIT_RATIO_MAX / (backend_bytes ?: 1) / 100,
+				sim->target_bytes[i] * SPLIT_RATIO_MAX / (backend_bytes ?: 1) % 100);
+	}
+
+	netcas_get_telemetry(sim->cache.splitter, &telemetry);
+	if (telemetry.hedges) {
+		printf("Hedged reads:         %" PRIu64 " (%" PRIu64 " won)\n",
+				telemetry.hedges, telemetry.hedge_wins);
+	}
+
+	if (sim->cfg.max_ratio_error && ratio_error > sim->cfg.max_ratio_error) {
+		printf("FAIL: ratio error above %u.%02u %%\n",
+				sim->cfg.max_ratio_error / 100,
+				sim->cfg.max_ratio_error % 100);
+		result = 1;
+	}
+	if (sim->cfg.min_throughput && throughput < sim->cfg.min_throughput) {
+		printf("FAIL: throughput below %" PRIu64 " MiB/s\n",
+				sim->cfg.min_throughput);
+		result = 1;
+	}
+	if (sim->cfg.max_tail_latency && tail_latency > sim->cfg.max_tail_latency) {
+		printf("FAIL: p99.9 read latency above %" PRIu64 " us\n",
+				sim->cfg.max_tail_latency);
+		result = 1;
+	}
+	if (sim->cfg.max_transitions && sim->transitions > sim->cfg.max_transitions) {
+		printf("FAIL: mode transitions above %u\n",
+				sim->cfg.max_transitions);
+		result = 1;
+	}
+
+	return result;
+}
+
+/* *** Command line *** */
+
+static void usage(const char *name)
+{
+	printf("Usage: %s [option...]\n"
+		"  --duration MS          simulated time (default 10000)\n"
+		"  --jobs N               closed loop jobs (default 4)\n"
+		"  --qd N                 reads in flight per job (default 16)\n"
+		"  --bs SIZE[,SIZE...]    read sizes in bytes, picked uniformly (default 65536)\n"
+		"  --hit PERCENT          cache hit ratio (default 100)\n"
+		"  --dirty PERCENT        share of hits on dirty lines (default 0)\n"
+		"  --cpus N               CPUs jobs are spread over (default 4)\n"
+		"  --cache-bw MIBPS       cache device bandwidth (default 3000)\n"
+		"  --cache-lat US         cache device latency (default 80)\n"
+		"  --backend-bw MIBPS     backend link bandwidth (default 2000)\n"
+		"  --backend-lat US       backend link latency (default 20)\n"
+		"  --targets MIBPS[,MIBPS...]  backend replicas with their bandwidth,\n"
+		"                         replaces --backend-bw\n"
+		"  --congestion START_MS:END_MS:BW_PERCENT:EXTRA_LAT_US[:TARGET]\n"
+		"                         backend congestion episode, may be repeated\n"
+		"  --policy NAME          formula or hill-climb (default formula)\n"
+		"  --p99-target US        p99 objective, 0 disables it (default 0)\n"
+		"  --hedge-budget PERMIL  hedged reads per clean hits, 0 disables (default 0)\n"
+		"  --hedge-percentile PERMIL  path latency percentile to hedge at\n"
+		"  --interval MS          monitor interval (default splitter default)\n"
+		"  --timer-slack US       monitor wakes up late by up to that (default 0)\n"
+		"  --seed N               random seed (default 1)\n"
+		"  --timeline FILE        write per interval CSV timeline\n"
+		"  --trace FILE           write splitter trace for netcas_replay\n"
+		"  --trace-sampling N     trace one in N requests (default 1)\n"
+		"  --max-ratio-error PERCENT  fail if mean ratio error is above\n"
+		"  --min-throughput MIBPS fail if throughput is below\n"
+		"  --max-tail-latency US  fail if p99.9 read latency is above\n"
+		"  --max-transitions N    fail if the mode changes more often\n"
+		"  --verbose              print splitter log\n", name);
+}
+
+static int parse_u64(const char *str, uint64_t *value)
+{
+	char *end;
+
+	errno = 0;
+	*value = strtoull(str, &end, 10);
+	if (errno || end == str || *end)
+		return -EINVAL;
+
+	return 0;
+}
+
+static int parse_sizes(struct sim_config *cfg, char *str)
+{
+	char *token, *save;
+	uint64_t size;
+
+	cfg->sizes_no = 0;
+	for (token = strtok_r(str, ",", &save); token;
+			token = strtok_r(NULL, ",", &save)) {
+		if (cfg->sizes_no == SIM_MAX_SIZES || parse_u64(token, &size) ||
+				!size || size > UINT32_MAX)
+			return -EINVAL;
+		cfg->sizes[cfg->sizes_no++] = size;
+	}
+
+	return cfg->sizes_no ? 0 : -EINVAL;
+}
+
+static int parse_episode(struct sim_config *cfg, const char *str)
+{
+	struct sim_episode *episode;
+	unsigned long long start, end, bw, lat;
+	int target = -1, fields;
+
+	if (cfg->episodes_no == SIM_MAX_EPISODES)
+		return -EINVAL;
+
+	fields = sscanf(str, "%llu:%llu:%llu:%llu:%d", &start, &end, &bw, &lat,
+			&target);
+	if (fields < 4 || start >= end || bw > 100 || target < -1 ||
+			target >= NETCAS_TARGET_MAX)
+		return -EINVAL;
+
+	episode = &cfg->episodes[cfg->episodes_no++];
+	episode->start_ns = start * NSEC_PER_MSEC;
+	episode->end_ns = end * NSEC_PER_MSEC;
+	episode->bw_percent = bw;
+	episode->extra_latency_ns = lat * NSEC_PER_USEC;
+	episode->target = target;
+
+	return 0;
+}
+
+static int parse_targets(struct sim_config *cfg, char *str)
+{
+	char *token, *save;
+	uint64_t bandwidth;
+
+	cfg->targets_no = 0;
+	for (token = strtok_r(str, ",", &save); token;
+			token = strtok_r(NULL, ",", &save)) {
+		if (cfg->targets_no == NETCAS_TARGET_MAX ||
+				parse_u64(token, &bandwidth) || !bandwidth ||
+				bandwidth > UINT32_MAX)
+			return -EINVAL;
+		cfg->target_bw[cfg->targets_no++] = bandwidth;
+	}
+
+	return cfg->targets_no >= 2 ? 0 : -EINVAL;
+}
+
+enum {
+	OPT_DURATION = 256,
+	OPT_JOBS,
+	OPT_QD,
+	OPT_BS,
+	OPT_HIT,
+	OPT_DIRTY,
+	OPT_CPUS,
+	OPT_CACHE_BW,
+	OPT_CACHE_LAT,
+	OPT_BACKEND_BW,
+	OPT_BACKEND_LAT,
+	OPT_TARGETS,
+	OPT_CONGESTION,
+	OPT_POLICY,
+	OPT_P99_TARGET,
+	OPT_HEDGE_BUDGET,
+	OPT_HEDGE_PERCENTILE,
+	OPT_INTERVAL,
+	OPT_TIMER_SLACK,
+	OPT_SEED,
+	OPT_TIMELINE,
+	OPT_TRACE,
+	OPT_TRACE_SAMPLING,
+	OPT_MAX_RATIO_ERROR,
+	OPT_MIN_THROUGHPUT,
+	OPT_MAX_TAIL_LATENCY,
+	OPT_MAX_TRANSITIONS,
+	OPT_VERBOSE,
+	OPT_HELP,
+};
+
+static const struct option options[] = {
+	{ "duration", required_argument, NULL, OPT_DURATION },
+	{ "jobs", required_argument, NULL, OPT_JOBS },
+	{ "qd", required_argument, NULL, OPT_QD },
+	{ "bs", required_argument, NULL, OPT_BS },
+	{ "hit", required_argument, NULL, OPT_HIT },
+	{ "dirty", required_argument, NULL, OPT_DIRTY },
+	{ "cpus", required_argument, NULL, OPT_CPUS },
+	{ "cache-bw", required_argument, NULL, OPT_CACHE_BW },
+	{ "cache-lat", required_argument, NULL, OPT_CACHE_LAT },
+	{ "backend-bw", required_argument, NULL, OPT_BACKEND_BW },
+	{ "backend-lat", required_argument, NULL, OPT_BACKEND_LAT },
+	{ "targets", required_argument, NULL, OPT_TARGETS },
+	{ "congestion", required_argument, NULL, OPT_CONGESTION },
+	{ "policy", required_argument, NULL, OPT_POLICY },
+	{ "p99-target", required_argument, NULL, OPT_P99_TARGET },
+	{ "hedge-budget", required_argument, NULL, OPT_HEDGE_BUDGET },
+	{ "hedge-percentile", required_argument, NULL, OPT_HEDGE_PERCENTILE },
+	{ "interval", required_argument, NULL, OPT_INTERVAL },
+	{ "timer-slack", required_argument, NULL, OPT_TIMER_SLACK },
+	{ "seed", required_argument, NULL, OPT_SEED },
+	{ "timeline", required_argument, NULL, OPT_TIMELINE },
+	{ "trace", required_argument, NULL, OPT_TRACE },
+	{ "trace-sampling", required_argument, NULL, OPT_TRACE_SAMPLING },
+	{ "max-ratio-error", required_argument, NULL, OPT_MAX_RATIO_ERROR },
+	{ "min-throughput", required_argument, NULL, OPT_MIN_THROUGHPUT },
+	{ "max-tail-latency", required_argument, NULL, OPT_MAX_TAIL_LATENCY },
+	{ "max-transitions", required_argument, NULL, OPT_MAX_TRANSITIONS },
+	{ "verbose", no_argument, NULL, OPT_VERBOSE },
+	{ "help", no_argument, NULL, OPT_HELP },
+	{ 0 }
+};
+
+static int parse_args(struct sim *sim, int argc, char *argv[])
+{
+	struct sim_config *cfg = &sim->cfg;
+	uint64_t value = 0;
+	double percent;
+	uint32_t i;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
+		switch (opt) {
+		case OPT_BS:
+			if (parse_sizes(cfg, optarg))
+				goto invalid;
+			continue;
+		case OPT_TARGETS:
+			if (parse_targets(cfg, optarg))
+				goto invalid;
+			continue;
+		case OPT_CONGESTION:
+			if (parse_episode(cfg, optarg))
+				goto invalid;
+			continue;
+		case OPT_POLICY:
+			if (!strcmp(optarg, "formula"))
+				cfg->policy = NETCAS_POLICY_FORMULA;
+			else if (!strcmp(optarg, "hill-climb"))
+				cfg->policy = NETCAS_POLICY_HILL_CLIMB;
+			else
+				goto invalid;
+			continue;
+		case OPT_TIMELINE:
+			cfg->timeline = optarg;
+			continue;
+		case OPT_TRACE:
+			cfg->trace = optarg;
+			continue;
+		case OPT_MAX_RATIO_ERROR:
+			if (sscanf(optarg, "%lf", &percent) != 1 || percent <= 0)
+				goto invalid;
+			cfg->max_ratio_error = percent * 100;
+			continue;
+		case OPT_VERBOSE:
+			netcas_sim_verbose = 1;
+			netcas_set_debug(1);
+			continue;
+		case OPT_HELP:
+			usage(argv[0]);
+			exit(0);
+		case '?':
+			return -EINVAL;
+		}
+
+		if (parse_u64(optarg, &value))
+			goto invalid;
+
+		switch (opt) {
+		case OPT_DURATION:
+			cfg->duration_ns = value * NSEC_PER_MSEC;
+			break;
+		case OPT_JOBS:
+			cfg->jobs = value;
+			break;
+		case OPT_QD:
+			cfg->qd = value;
+			break;
+		case OPT_HIT:
+			cfg->hit_percent = value;
+			break;
+		case OPT_DIRTY:
+			cfg->dirty_percent = value;
+			break;
+		case OPT_CPUS:
+			netcas_sim_cpus = value;
+			break;
+		case OPT_CACHE_BW:
+			sim->link[NETCAS_PATH_CACHE].bandwidth = value * MiB;
+			break;
+		case OPT_CACHE_LAT:
+			sim->link[NETCAS_PATH_CACHE].latency_ns = value * NSEC_PER_USEC;
+			break;
+		case OPT_BACKEND_BW:
+			sim->link[NETCAS_PATH_BACKEND].bandwidth = value * MiB;
+			break;
+		case OPT_BACKEND_LAT:
+			sim->link[NETCAS_PATH_BACKEND].latency_ns = value * NSEC_PER_USEC;
+			break;
+		case OPT_P99_TARGET:
+			cfg->p99_target_ns = value * NSEC_PER_USEC;
+			break;
+		case OPT_HEDGE_BUDGET:
+			cfg->hedge_budget = value;
+			break;
+		case OPT_HEDGE_PERCENTILE:
+			cfg->hedge_percentile = value;
+			break;
+		case OPT_INTERVAL:
+			cfg->interval_ms = value;
+			break;
+		case OPT_TIMER_SLACK:
+			cfg->timer_slack_ns = value * NSEC_PER_USEC;
+			break;
+		case OPT_SEED:
+			cfg->seed = value;
+			break;
+		case OPT_TRACE_SAMPLING:
+			cfg->trace_sampling = value;
+			break;
+		case OPT_MIN_THROUGHPUT:
+			cfg->min_throughput = value;
+			break;
+		case OPT_MAX_TAIL_LATENCY:
+			cfg->max_tail_latency = value;
+			break;
+		case OPT_MAX_TRANSITIONS:
+			cfg->max_transitions = value;
+			break;
+		}
+	}
+
+	/* Replicas share backend latency, their sum stands for the backend */
+	if (cfg->targets_no) {
+		sim->link[NETCAS_PATH_BACKEND].bandwidth = 0;
+		for (i = 0; i < cfg->targets_no; i++) {
+			sim->target[i].bandwidth = cfg->target_bw[i] * MiB;
+			sim->target[i].latency_ns =
+				sim->link[NETCAS_PATH_BACKEND].latency_ns;
+			sim->link[NETCAS_PATH_BACKEND].bandwidth +=
+				sim->target[i].bandwidth;
+		}
+	}
+
+	for (i = 0; i < cfg->episodes_no; i++) {
+		if (cfg->episodes[i].target >= (int)cfg->targets_no) {
+			fprintf(stderr, "Congestion of a target out of --targets\n");
+			return -EINVAL;
+		}
+	}
+
+	if (optind != argc || !cfg->duration_ns || !cfg->jobs || !cfg->qd ||
+			cfg->hit_percent > 100 || cfg->dirty_percent > 100 ||
+			!netcas_sim_cpus ||
+			!sim->link[NETCAS_PATH_CACHE].bandwidth ||
+			!sim->link[NETCAS_PATH_BACKEND].bandwidth) {
+		fprintf(stderr, "Invalid configuration\n");
+		return -EINVAL;
+	}
+
+	return 0;
+
+invalid:
+	fprintf(stderr, "Invalid value '%s' of option --%s\n", optarg,
+			options[opt - OPT_DURATION].name);
+	return -EINVAL;
+}
+
+int main(int argc, char *argv[])
+{
+	static struct sim sim = {
+		.cfg = {
+			.duration_ns = 10000 * NSEC_PER_MSEC,
+			.jobs = 4,
+			.qd = 16,
+			.sizes = { 65536 },
+			.sizes_no = 1,
+			.hit_percent = 100,
+			.policy = NETCAS_POLICY_FORMULA,
+			.seed = 1,
+			.trace_sampling = 1,
+		},
+		.link = {
+			[NETCAS_PATH_CACHE] = {
+				.bandwidth = 3000 * MiB,
+				.latency_ns = 80 * NSEC_PER_USEC,
+			},
+			[NETCAS_PATH_BACKEND] = {
+				.bandwidth = 2000 * MiB,
+				.latency_ns = 20 * NSEC_PER_USEC,
+			},
+		},
+	};
+	int result;
+
+	if (parse_args(&sim, argc, argv)) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	if (sim.cfg.timeline) {
+		sim.timeline = fopen(sim.cfg.timeline, "w");
+		if (!sim.timeline) {
+			perror(sim.cfg.timeline);
+			return 2;
+		}
+		fprintf(sim.timeline, "time_ms,mode,optimal_ratio,achieved_ratio,"
+				"ideal_ratio,cache_mibps,backend_mibps,"
+				"backend_latency_us\n");
+	}
+
+	if (sim.cfg.trace) {
+		sim.trace = fopen(sim.cfg.trace, "wb");
+		if (!sim.trace) {
+			perror(sim.cfg.trace);
+			return 2;
+		}
+	}
+
+	result = sim_init(&sim);
+	if (result) {
+		fprintf(stderr, "Failed to initialize simulation: %d\n", result);
+		return 2;
+	}
+
+	sim_run(&sim);
+	result = sim_report(&sim);
+
+	sim_deinit(&sim);
+	if (sim.timeline)
+		fclose(sim.timeline);
+	if (sim.trace)
+		fclose(sim.trace);
+
+	return result;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "sim_env.h"
+
+/* Simulated environment, see include/ocf_env.h */
+uint64_t netcas_sim_clock_ns;
+unsigned netcas_sim_cpu;
+unsigned netcas_sim_cpus = 4;
+int netcas_sim_verbose;
+struct task_struct netcas_sim_task;
+
+const char *sim_mode_names[NETCAS_MODE_FAILURE + 1] = {
+	"IDLE",
+	"WARMUP",
+	"STABLE",
+	"CONGESTION",
+	"FAILURE",
+};
+
+/* *** Hooks called by netCAS sources *** */
+
+const char *ocf_cache_get_name(ocf_cache_t cache)
+{
+	return cache->name;
+}
+
+ocf_core_id_t ocf_core_get_id(ocf_core_t core)
+{
+	return core->id;
+}
+
+struct netcas_splitter *env_netcas_get_splitter(struct ocf_cache *cache)
+{
+	return cache->splitter;
+}
+
+void sim_run_as(uint32_t job)
+{
+	netcas_sim_cpu = job % netcas_sim_cpus;
+	netcas_sim_task.pid = job + 1;
+}
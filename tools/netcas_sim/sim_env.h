@@ -0,0 +1,47 @@
+/*
+ * Copyright(c) 2012-2021 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __SIM_ENV_H__
+#define __SIM_ENV_H__
+
+/*
+ * Environment shared by userspace tools driving netCAS sources: simulated
+ * clock and CPU, see include/ocf_env.h, and the cache object they belong to.
+ * Each tool provides measure_performance() and lookup_bandwidth() itself.
+ */
+
+#include <stdint.h>
+
+#include <linux/sched.h>
+#include "ocf/ocf.h"
+#include "src/ocf_request.h"
+#include "src/engine/netCAS_monitor.h"
+#include "src/utils/pmem_nvme/pmem_nvme_table.h"
+#include "netCAS_splitter.h"
+
+#define MSEC_PER_SEC UINT64_C(1000)
+#define NSEC_PER_USEC UINT64_C(1000)
+#define NSEC_PER_MSEC UINT64_C(1000000)
+#define NSEC_PER_SEC UINT64_C(1000000000)
+#define MiB (UINT64_C(1024) * 1024)
+
+struct ocf_cache {
+	const char *name;
+	struct netcas_splitter *splitter;
+};
+
+struct ocf_core {
+	ocf_core_id_t id;
+};
+
+extern int netcas_sim_verbose;
+extern struct task_struct netcas_sim_task;
+
+extern const char *sim_mode_names[NETCAS_MODE_FAILURE + 1];
+
+/* Run following calls into netCAS as given job, spread over CPUs */
+void sim_run_as(uint32_t job);
+
+#endif /* __SIM_ENV_H__ */